@@ -0,0 +1,50 @@
+#include <pretty_print/pretty_print.hpp>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace {
+
+    struct record {
+        int id;
+        double value;
+        std::string name;
+    };
+
+    struct written_record {
+        int id;
+        double value;
+        std::string name;
+    };
+
+    /** what the aggregate printing replaces: the fields chained through operator<< by hand */
+    std::ostream& operator<<(std::ostream& out, const written_record& data) {
+        return out << '{' << data.id << ", " << data.value << ", " << pretty::detail::quoted_helper(data.name) << '}';
+    }
+
+}  // namespace
+
+void bench_aggregate() {
+    std::vector<written_record> written(1000);
+    std::vector<record> aggregates(1000);
+    for (int i = 0; i < 1000; ++i) {
+        written[i] = {i, i / 4.0, "name_" + std::to_string(i)};
+        aggregates[i] = {i, i / 4.0, "name_" + std::to_string(i)};
+    }
+
+    std::string str;
+    const double written_ns = bench::measure([&] {
+        str.clear();
+        pretty::format_to(str, written);
+        bench::do_not_optimize(str);
+    });
+    bench::report("vector<struct> / operator<<", written_ns);
+
+    const double aggregate_ns = bench::measure([&] {
+        str.clear();
+        pretty::format_to(str, aggregates);
+        bench::do_not_optimize(str);
+    });
+    bench::report("vector<struct> / aggregate", aggregate_ns, written_ns);
+}
@@ -0,0 +1,23 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "bench.hpp"
+
+namespace {
+    std::atomic<std::size_t> allocation_count{0};
+}
+
+/** replaced global allocation functions count every allocation in the program */
+void* operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size != 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+std::size_t bench::allocations() noexcept { return allocation_count.load(std::memory_order_relaxed); }
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <pretty_print/pretty_print.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace {
+
+    constexpr int thread_count = 4;
+    constexpr int calls_per_thread = 20000;
+
+    /** call fn from several threads at once, return the sorted latencies of all calls in ns */
+    template <class F>
+    std::vector<double> latencies(F&& fn) {
+        using clock = std::chrono::steady_clock;
+        std::vector<std::vector<double>> results(thread_count);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&, t] {
+                const std::map<std::string, int> data = {{"request", t}, {"status", 200}};
+                results[t].reserve(calls_per_thread);
+                for (int i = 0; i < calls_per_thread; ++i) {
+                    const auto start = clock::now();
+                    fn(i, data);
+                    results[t].push_back(std::chrono::duration<double, std::nano>(clock::now() - start).count());
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        std::vector<double> all;
+        for (const auto& result : results) {
+            all.insert(all.end(), result.begin(), result.end());
+        }
+        std::sort(all.begin(), all.end());
+        return all;
+    }
+
+    void report(const std::string& name, const std::vector<double>& ns) {
+        bench::report(name + " p50", ns[ns.size() / 2]);
+        bench::report(name + " p99", ns[ns.size() * 99 / 100]);
+    }
+
+}  // namespace
+
+void bench_async() {
+    std::ofstream stream("/dev/null");
+    std::mutex mutex;
+    report("print_line(std::ofstream) under mutex, 4 threads", latencies([&](int i, const auto& data) {
+               std::lock_guard<std::mutex> lock(mutex);
+               pretty::print_line(stream, i, data);
+           }));
+
+    std::FILE* file = std::fopen("/dev/null", "w");
+    if (!file) {
+        return;
+    }
+    {
+        // the sink writes its buffer to the descriptor of file when destroyed, before the file is closed
+        pretty::file_sink sink(file);
+        for (const auto policy : {pretty::overflow_policy::block, pretty::overflow_policy::grow}) {
+            pretty::async_printer<pretty::file_sink> out(sink, 4096, policy);
+            report(std::string("async_printer::print_line, ") +
+                       (policy == pretty::overflow_policy::block ? "block" : "grow") + ", 4 threads",
+                   latencies([&](int i, const auto& data) { out.print_line(i, data); }));
+        }
+    }
+    std::fclose(file);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <chrono>    // std::chrono::steady_clock
+#include <cstddef>   // std::size_t
+#include <iomanip>   // std::setw
+#include <iostream>  // std::cout
+#include <string>    // std::string
+
+namespace bench {
+
+    /** number of operator new calls in the program so far, see allocations.cpp */
+    std::size_t allocations() noexcept;
+
+    /** keep the optimizer from dropping a computed value */
+    template <class T>
+    void do_not_optimize(const T& value) {
+#if defined(__GNUC__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static const volatile void* sink;
+        sink = &value;
+#endif
+    }
+
+    /** run fn until min_time has passed, return nanoseconds per call */
+    template <class F>
+    double measure(F&& fn, std::chrono::milliseconds min_time = std::chrono::milliseconds(200)) {
+        using clock = std::chrono::steady_clock;
+        fn();  // warm up
+        std::size_t iterations = 0;
+        const auto start = clock::now();
+        auto now = start;
+        do {
+            fn();
+            ++iterations;
+            now = clock::now();
+        } while (now - start < min_time);
+        return std::chrono::duration<double, std::nano>(now - start).count() / static_cast<double>(iterations);
+    }
+
+    /** print one result line: name, ns per call, and speedup against a baseline */
+    inline void report(const std::string& name, double ns, double baseline_ns = 0) {
+        std::cout << std::left << std::setw(56) << name << std::right << std::setw(14) << std::fixed
+                  << std::setprecision(1) << ns << " ns";
+        if (baseline_ns > 0) {
+            std::cout << std::setw(10) << std::setprecision(2) << baseline_ns / ns << "x";
+        }
+        std::cout << '\n';
+    }
+
+}  // namespace bench
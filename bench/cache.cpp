@@ -0,0 +1,36 @@
+#include <map>
+#include <pretty_print/pretty_print.hpp>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+void bench_cache() {
+    std::map<std::string, std::vector<double>> registry;
+    for (int i = 0; i < 10000; ++i) {
+        registry["service_" + std::to_string(i)] = std::vector<double>(16, i / 3.0);
+    }
+
+    std::string str;
+    const double print_ns = bench::measure([&] {
+        str.clear();
+        pretty::format_to(str, registry);
+        bench::do_not_optimize(str);
+    });
+    bench::report("map<string, vector<double>>(10k) / format_to", print_ns);
+
+    pretty::cached_printer cache(16 << 20);
+    int i = 0;
+    const double element_ns = bench::measure([&] {
+        registry["service_" + std::to_string(i++ % 10000)][0] += 1;
+        str = cache.print(registry);
+        bench::do_not_optimize(str);
+    });
+    bench::report("map<string, vector<double>>(10k) / cached, 1 dirty", element_ns, print_ns);
+
+    const double version_ns = bench::measure([&] {
+        str = cache.print(registry, 1);
+        bench::do_not_optimize(str);
+    });
+    bench::report("map<string, vector<double>>(10k) / cached, same version", version_ns, print_ns);
+}
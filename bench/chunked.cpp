@@ -0,0 +1,33 @@
+#include <map>
+#include <pretty_print/pretty_print.hpp>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+void bench_chunked() {
+    std::map<std::string, std::vector<int>> data;
+    for (int i = 0; i < 1000; ++i) {
+        data["request_" + std::to_string(i)] = std::vector<int>(50, i);
+    }
+    const std::string name = "map<string, vector<int>>(1000 x 50)";
+
+    std::string str;
+    const double whole_ns = bench::measure([&] {
+        str.clear();
+        pretty::format_to(str, data);
+        bench::do_not_optimize(str);
+    });
+    bench::report(name + " / format_to whole", whole_ns);
+
+    for (const std::size_t size : {std::size_t{256}, std::size_t{4096}}) {
+        std::vector<char> buf(size);
+        const double chunked_ns = bench::measure([&] {
+            pretty::chunked_formatter f(data);
+            while (!f.done()) {
+                bench::do_not_optimize(f.next(buf.data(), buf.size()));
+            }
+        });
+        bench::report(name + " / chunked_formatter " + std::to_string(size) + " B", chunked_ns, whole_ns);
+    }
+}
@@ -0,0 +1,48 @@
+// Build time and .text size of the print path: a TU that prints many distinct nested types.
+// Not part of pretty_print_bench, built by the compile_time target, see CMakeLists.txt.
+#include <array>
+#include <list>
+#include <map>
+#include <optional>
+#include <pretty_print/pretty_print.hpp>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace {
+
+    template <int I>
+    struct tag {
+        int value = I;
+    };
+
+    using leaf = std::variant<int, double, std::string, std::optional<long>>;
+    using row = std::tuple<int, std::string, std::vector<leaf>, std::pair<char, bool>>;
+    using deep = std::vector<std::vector<std::vector<std::vector<std::vector<std::vector<row>>>>>>;
+
+    template <class T>
+    std::string all_sinks(const T& data) {
+        std::ostringstream out;
+        pretty::print(out, data);
+        std::string str = pretty::print(data);
+        pretty::format_to(str, data);
+        return out.str() + str + std::to_string(pretty::formatted_size(data)) + pretty::print(data, pretty::limits{}) +
+               pretty::print(data, pretty::indent{});
+    }
+
+}  // namespace
+
+std::string compile_time_print() {
+    std::string result;
+    result += all_sinks(deep{});
+    result += all_sinks(std::map<std::string, std::map<int, std::vector<row>>>{});
+    result += all_sinks(std::unordered_map<int, std::list<std::set<leaf>>>{});
+    result += all_sinks(std::array<std::array<std::tuple<leaf, leaf, tag<1>>, 2>, 2>{});
+    result += all_sinks(std::vector<std::map<int, std::vector<std::optional<std::pair<int, tag<2>>>>>>{});
+    result += all_sinks(std::tuple<deep, std::vector<deep>, std::optional<deep>>{});
+    return result;
+}
@@ -0,0 +1,44 @@
+#include <map>
+#include <pretty_print/pretty_print.hpp>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+void bench_diff() {
+    std::map<std::string, std::vector<int>> a;
+    for (int i = 0; i < 100000; ++i) {
+        a["replica_key_" + std::to_string(i)] = std::vector<int>(8, i);
+    }
+    auto b = a;
+    b["replica_key_500"][3] = -1;
+    b.erase("replica_key_70000");
+    b["replica_key_x"] = {1};
+
+    std::string text_a;
+    std::string text_b;
+    const double print_ns = bench::measure([&] {
+        text_a.clear();
+        text_b.clear();
+        pretty::format_to(text_a, a);
+        pretty::format_to(text_b, b);
+        bench::do_not_optimize(text_a == text_b);
+    });
+    bench::report("map<string, vector<int>>(100k) / print both", print_ns);
+
+    const double diff_ns = bench::measure([&] {
+        std::string changes = pretty::diff(a, b);
+        bench::do_not_optimize(changes);
+    });
+    bench::report("map<string, vector<int>>(100k) / diff, 3 changes", diff_ns, print_ns);
+
+    // lower bound: a full merge walk comparing every key and value, without reporting anything
+    const double walk_ns = bench::measure([&] {
+        std::size_t equal = 0;
+        for (auto it_a = a.begin(), it_b = b.begin(); it_a != a.end() && it_b != b.end(); ++it_a, ++it_b) {
+            equal += it_a->first == it_b->first && it_a->second == it_b->second;
+        }
+        bench::do_not_optimize(equal);
+    });
+    bench::report("map<string, vector<int>>(100k) / compare walk", walk_ns, print_ns);
+}
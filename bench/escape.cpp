@@ -0,0 +1,84 @@
+#include <iomanip>
+#include <pretty_print/pretty_print.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace {
+
+    void compare(const std::string& name, const std::vector<std::string>& data) {
+        std::size_t bytes = 0;
+        for (const auto& str : data) {
+            bytes += str.size();
+        }
+
+        const double quoted_ns = bench::measure([&] {
+            std::stringstream out;
+            for (const auto& str : data) {
+                out << std::quoted(str);
+            }
+            bench::do_not_optimize(out);
+        });
+        bench::report(name + " / std::quoted to stringstream", quoted_ns);
+
+        const double stream_ns = bench::measure([&] {
+            std::stringstream out;
+            for (const auto& str : data) {
+                out << pretty::detail::quoted_helper(str);
+            }
+            bench::do_not_optimize(out);
+        });
+        bench::report(name + " / quoted_helper to stringstream", stream_ns, quoted_ns);
+
+        std::string out;
+        const double writer_ns = bench::measure([&] {
+            out.clear();
+            for (const auto& str : data) {
+                pretty::format_to(out, str);
+            }
+            bench::do_not_optimize(out);
+        });
+        bench::report(name + " / format_to(std::string&)", writer_ns, quoted_ns);
+
+        using pretty::detail::find_escape_fn;
+        const std::pair<const char*, find_escape_fn> kernels[] = {
+            {"scalar", &pretty::detail::find_escape_scalar},
+#if defined(PRETTY_PRINT_HAS_SSE2)
+            {"sse2", &pretty::detail::find_escape_sse2},
+#endif
+#if defined(PRETTY_PRINT_HAS_AVX2)
+            {"avx2", __builtin_cpu_supports("avx2") ? &pretty::detail::find_escape_avx2 : nullptr},
+#endif
+        };
+        for (const auto& [kernel, find] : kernels) {
+            if (!find) {
+                continue;
+            }
+            const double scan_ns = bench::measure([&, find = find] {
+                for (const auto& str : data) {
+                    const char* last = str.data() + str.size();
+                    for (const char* it = find(str.data(), last); it != last; it = find(it + 1, last)) {
+                    }
+                    bench::do_not_optimize(last);
+                }
+            });
+            bench::report(name + " / scan " + kernel + " (" +
+                              std::to_string(static_cast<int>(static_cast<double>(bytes) / scan_ns * 1000)) + " MB/s)",
+                          scan_ns);
+        }
+    }
+
+}  // namespace
+
+void bench_escape() {
+    compare("short strings", std::vector<std::string>(10000, "key_1234"));
+    compare("long strings", std::vector<std::string>(100, std::string(4096, 'a')));
+
+    std::string heavy;
+    for (int i = 0; i < 1024; ++i) {
+        heavy += "a\"b\\c\n";
+    }
+    compare("escape-heavy strings", std::vector<std::string>(100, heavy));
+}
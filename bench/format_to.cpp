@@ -0,0 +1,51 @@
+#include <map>
+#include <pretty_print/pretty_print.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace {
+
+    template <class T>
+    void compare(const std::string& name, const T& data) {
+        const double stream_ns = bench::measure([&] {
+            std::stringstream out;
+            pretty::print(out, data);
+            bench::do_not_optimize(out);
+        });
+        bench::report(name + " / print(stringstream)", stream_ns);
+
+        std::string str;
+        const double string_ns = bench::measure([&] {
+            str.clear();
+            pretty::format_to(str, data);
+            bench::do_not_optimize(str);
+        });
+        bench::report(name + " / format_to(std::string&)", string_ns, stream_ns);
+
+        std::vector<char> buf(str.size());
+        const double buffer_ns = bench::measure([&] {
+            bench::do_not_optimize(pretty::format_to(buf.data(), data));
+        });
+        bench::report(name + " / format_to(char*)", buffer_ns, stream_ns);
+    }
+
+}  // namespace
+
+void bench_format_to() {
+    std::map<std::string, std::vector<int>> map_of_vectors;
+    for (int i = 0; i < 1000; ++i) {
+        map_of_vectors["key_" + std::to_string(i)] = std::vector<int>(16, i * 1000);
+    }
+    compare("map<string, vector<int>>", map_of_vectors);
+
+    std::vector<std::map<int, double>> vector_of_maps(1000);
+    for (std::size_t i = 0; i < vector_of_maps.size(); ++i) {
+        for (int j = 0; j < 16; ++j) {
+            vector_of_maps[i][j] = static_cast<double>(i) / (j + 1);
+        }
+    }
+    compare("vector<map<int, double>>", vector_of_maps);
+}
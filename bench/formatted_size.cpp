@@ -0,0 +1,48 @@
+#include <map>
+#include <pretty_print/pretty_print.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace {
+
+    template <class T>
+    void compare(const std::string& name, const T& data) {
+        const double stream_ns = bench::measure([&] {
+            std::stringstream out;
+            pretty::print(out, data);
+            bench::do_not_optimize(out.str());
+        });
+        bench::report(name + " / stringstream + str()", stream_ns);
+
+        const double growth_ns = bench::measure([&] {
+            std::string str;
+            pretty::format_to(str, data);
+            bench::do_not_optimize(str);
+        });
+        bench::report(name + " / format_to with growth", growth_ns, stream_ns);
+
+        const double size_ns = bench::measure([&] { bench::do_not_optimize(pretty::formatted_size(data)); });
+        bench::report(name + " / formatted_size", size_ns, stream_ns);
+
+        const double print_ns = bench::measure([&] { bench::do_not_optimize(pretty::print(data)); });
+        bench::report(name + " / print (size + reserve + format)", print_ns, stream_ns);
+    }
+
+}  // namespace
+
+void bench_formatted_size() {
+    std::vector<int> ints(100000);
+    for (std::size_t i = 0; i < ints.size(); ++i) {
+        ints[i] = static_cast<int>(i * 7919);
+    }
+    compare("vector<int>(100k)", ints);
+
+    std::map<std::string, int> map;
+    for (int i = 0; i < 100000; ++i) {
+        map["key \"" + std::to_string(i) + "\""] = i;
+    }
+    compare("map<string, int>(100k)", map);
+}
@@ -0,0 +1,43 @@
+#include <memory>
+#include <pretty_print/pretty_print.hpp>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace {
+
+    struct node {
+        int value;
+        std::vector<std::shared_ptr<node>> next;
+    };
+
+}  // namespace
+
+void bench_graph() {
+    for (const int size : {100, 10000}) {
+        // every node is reached twice from the one above it: 2^size paths, size objects
+        std::vector<std::shared_ptr<node>> chain = {std::make_shared<node>(node{0, {}})};
+        for (int i = 1; i < size; ++i) {
+            chain.push_back(std::make_shared<node>(node{i, {chain.back(), chain.back()}}));
+        }
+        const std::string name = "diamond chain(" + std::to_string(size) + ")";
+
+        std::vector<std::pair<int, std::vector<int>>> flat;
+        for (int i = 0; i < size; ++i) {
+            flat.emplace_back(i, std::vector<int>{i, i});
+        }
+        std::string str;
+        const double flat_ns = bench::measure([&] {
+            str = pretty::print(flat);
+            bench::do_not_optimize(str);
+        });
+        bench::report(name + " / same values as vector<pair>", flat_ns);
+
+        const double graph_ns = bench::measure([&] {
+            str = pretty::print(chain.back(), pretty::deref_pointers{});
+            bench::do_not_optimize(str);
+        });
+        bench::report(name + " / deref_pointers", graph_ns, flat_ns);
+    }
+}
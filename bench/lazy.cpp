@@ -0,0 +1,32 @@
+#include <map>
+#include <pretty_print/pretty_print.hpp>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace {
+
+    /** a log statement whose level is disabled: the message is built, then dropped */
+    template <class Message>
+    void log_disabled(const Message& message) {
+        bench::do_not_optimize(message);
+    }
+
+}  // namespace
+
+void bench_lazy() {
+    std::map<std::string, std::vector<int>> data;
+    for (int i = 0; i < 100; ++i) {
+        data["key_" + std::to_string(i)] = std::vector<int>(16, i);
+    }
+
+    const double eager_ns = bench::measure([&] { log_disabled(pretty::print(data)); });
+    bench::report("disabled log / pretty::print(data)", eager_ns);
+
+    const double lazy_ns = bench::measure([&] { log_disabled(pretty::lazy(data)); });
+    bench::report("disabled log / pretty::lazy(data)", lazy_ns, eager_ns);
+
+    const double lazy_args_ns = bench::measure([&] { log_disabled(pretty::lazy_args("state", 42, data)); });
+    bench::report("disabled log / pretty::lazy_args(\"state\", 42, data)", lazy_args_ns, eager_ns);
+}
@@ -0,0 +1,81 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "suite.hpp"
+
+extern void bench_format_to();
+extern void bench_formatted_size();
+extern void bench_escape();
+extern void bench_numbers();
+extern void bench_sink();
+extern void bench_parallel();
+extern void bench_async();
+extern void bench_lazy();
+extern void bench_visit();
+extern void bench_parse();
+extern void bench_aggregate();
+extern void bench_static_print();
+extern void bench_diff();
+extern void bench_cache();
+extern void bench_sorted();
+extern void bench_type_name();
+extern void bench_utf();
+extern void bench_chunked();
+extern void bench_graph();
+
+namespace {
+
+    void usage() {
+        std::cerr << "usage: pretty_print_bench [--suite [--max-size N] [--min-time MS] [--filter TYPE] [--json FILE]]\n";
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bool suite = false;
+    bench::suite_options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--suite") {
+            suite = true;
+        } else if (arg == "--max-size" && has_value) {
+            options.max_size = std::stoull(argv[++i]);
+        } else if (arg == "--min-time" && has_value) {
+            options.min_time = std::chrono::milliseconds(std::stoll(argv[++i]));
+        } else if (arg == "--filter" && has_value) {
+            options.filter = argv[++i];
+        } else if (arg == "--json" && has_value) {
+            options.json = argv[++i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (suite) {
+        bench::run_suite(options);
+        return 0;
+    }
+
+    bench_format_to();
+    bench_formatted_size();
+    bench_escape();
+    bench_numbers();
+    bench_sink();
+    bench_parallel();
+    bench_async();
+    bench_lazy();
+    bench_visit();
+    bench_parse();
+    bench_aggregate();
+    bench_static_print();
+    bench_diff();
+    bench_cache();
+    bench_sorted();
+    bench_type_name();
+    bench_utf();
+    bench_chunked();
+    bench_graph();
+    return 0;
+}
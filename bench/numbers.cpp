@@ -0,0 +1,75 @@
+#include <array>
+#include <pretty_print/pretty_print.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace {
+
+    /** element-wise text of the same range, the path every range took before the bulk one */
+    template <class T>
+    void print_elementwise(std::string& out, const T& data) {
+        out += '[';
+        const char* delimiter = "";
+        for (const auto& el : data) {
+            out += delimiter;
+            pretty::format_to(out, el);
+            delimiter = ", ";
+        }
+        out += ']';
+    }
+
+    std::string throughput(std::size_t size, double ns) {
+        return " (" + std::to_string(static_cast<long long>(static_cast<double>(size) / ns * 1e3)) + " Melem/s)";
+    }
+
+    template <class T>
+    void compare(const std::string& name, const T& data) {
+        const std::size_t size = std::size(data);
+
+        std::string str;
+        const double elementwise_ns = bench::measure([&] {
+            str.clear();
+            print_elementwise(str, data);
+            bench::do_not_optimize(str);
+        });
+        bench::report(name + " / element-wise" + throughput(size, elementwise_ns), elementwise_ns);
+
+        const double string_ns = bench::measure([&] {
+            str.clear();
+            pretty::format_to(str, data);
+            bench::do_not_optimize(str);
+        });
+        bench::report(name + " / format_to(std::string&)" + throughput(size, string_ns), string_ns, elementwise_ns);
+
+        const double stream_ns = bench::measure([&] {
+            std::stringstream out;
+            pretty::print(out, data);
+            bench::do_not_optimize(out);
+        });
+        bench::report(name + " / print(stringstream)" + throughput(size, stream_ns), stream_ns, elementwise_ns);
+    }
+
+}  // namespace
+
+void bench_numbers() {
+    std::vector<int> ints(1000000);
+    for (std::size_t i = 0; i < ints.size(); ++i) {
+        ints[i] = static_cast<int>(i * 7919) - 1000000;
+    }
+    compare("vector<int>(1M)", ints);
+
+    std::vector<double> doubles(1000000);
+    for (std::size_t i = 0; i < doubles.size(); ++i) {
+        doubles[i] = static_cast<double>(i) / 7;
+    }
+    compare("vector<double>(1M)", doubles);
+
+    static std::array<float, 4096> floats;
+    for (std::size_t i = 0; i < floats.size(); ++i) {
+        floats[i] = static_cast<float>(i) * 0.25f;
+    }
+    compare("array<float, 4096>", floats);
+}
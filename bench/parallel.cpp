@@ -0,0 +1,36 @@
+#include <algorithm>
+#include <map>
+#include <pretty_print/pretty_print.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+
+void bench_parallel() {
+    std::vector<std::map<std::string, double>> data(100000);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        for (int j = 0; j < 4; ++j) {
+            data[i]["key_" + std::to_string(j)] = static_cast<double>(i) / (j + 1);
+        }
+    }
+
+    std::string str;
+    const double serial_ns = bench::measure([&] {
+        str.clear();
+        pretty::format_to(str, data);
+        bench::do_not_optimize(str);
+    });
+    bench::report("vector<map<string, double>>(100k) / serial", serial_ns);
+
+    const std::size_t max_threads = std::max(std::thread::hardware_concurrency(), 2u);
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        const double parallel_ns = bench::measure([&] {
+            str.clear();
+            pretty::detail::string_writer<std::string> out(str);
+            pretty::parallel_print(out, data, threads);
+        });
+        bench::report("vector<map<string, double>>(100k) / parallel_print, " + std::to_string(threads) + " threads",
+                      parallel_ns, serial_ns);
+    }
+}
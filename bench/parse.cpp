@@ -0,0 +1,53 @@
+#include <map>
+#include <pretty_print/pretty_print.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace {
+
+    std::string throughput(std::size_t bytes, double ns) {
+        std::ostringstream ss;
+        ss.precision(0);
+        ss << std::fixed << static_cast<double>(bytes) * 1e3 / ns << " MB/s";
+        return ss.str();
+    }
+
+    /** print data, then parse the text back, with the print time as the baseline */
+    template <class T>
+    void bench_round_trip(const std::string& name, const T& data) {
+        std::string text;
+        const double print_ns = bench::measure([&] {
+            text.clear();
+            pretty::format_to(text, data);
+            bench::do_not_optimize(text);
+        });
+        bench::report(name + " / print, " + throughput(text.size(), print_ns), print_ns);
+
+        const double parse_ns = bench::measure([&] {
+            T result = pretty::parse<T>(text);
+            bench::do_not_optimize(result);
+        });
+        bench::report(name + " / parse, " + throughput(text.size(), parse_ns), parse_ns, print_ns);
+    }
+
+}  // namespace
+
+void bench_parse() {
+    std::map<std::string, std::vector<int>> map;
+    for (int i = 0; i < 1000; ++i) {
+        map["key_" + std::to_string(i)] = std::vector<int>(16, i * 1000);
+    }
+    bench_round_trip("map<string, vector<int>>", map);
+
+    std::vector<double> doubles(10000);
+    for (std::size_t i = 0; i < doubles.size(); ++i) {
+        doubles[i] = static_cast<double>(i) / 7;
+    }
+    bench_round_trip("vector<double>", doubles);
+
+    std::vector<std::string> strings(10000, "line \"quoted\"\twith escapes");
+    bench_round_trip("vector<string>", strings);
+}
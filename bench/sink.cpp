@@ -0,0 +1,41 @@
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <pretty_print/pretty_print.hpp>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace {
+
+    template <class T>
+    void compare(const std::string& name, const T& data) {
+        std::ofstream stream("/dev/null");
+        const double stream_ns = bench::measure([&] { pretty::print(stream, data).flush(); });
+        bench::report(name + " / print(std::ofstream)", stream_ns);
+
+        std::FILE* file = std::fopen("/dev/null", "w");
+        if (!file) {
+            return;
+        }
+        pretty::file_sink sink(file);
+        const double sink_ns = bench::measure([&] {
+            pretty::print(sink, data);
+            sink.flush();
+        });
+        bench::report(name + " / print(file_sink)", sink_ns, stream_ns);
+        std::fclose(file);
+    }
+
+}  // namespace
+
+void bench_sink() {
+    std::map<std::string, std::vector<int>> map_of_vectors;
+    for (int i = 0; i < 10000; ++i) {
+        map_of_vectors["key_" + std::to_string(i)] = std::vector<int>(16, i * 1000);
+    }
+    compare("map<string, vector<int>>", map_of_vectors);
+
+    compare("vector<string> of 1 MiB strings", std::vector<std::string>(64, std::string(1 << 20, 'a')));
+}
@@ -0,0 +1,38 @@
+#include <map>
+#include <pretty_print/pretty_print.hpp>
+#include <string>
+#include <unordered_map>
+
+#include "bench.hpp"
+
+void bench_sorted() {
+    for (const int size : {50, 10000}) {
+        std::unordered_map<std::string, int> data;
+        for (int i = 0; i < size; ++i) {
+            data["service_" + std::to_string(i * 7919 % 100003)] = i;
+        }
+        const std::string name = "unordered_map<string, int>(" + std::to_string(size) + ")";
+
+        std::string str;
+        const double hash_ns = bench::measure([&] {
+            str.clear();
+            pretty::format_to(str, data);
+            bench::do_not_optimize(str);
+        });
+        bench::report(name + " / hash order", hash_ns);
+
+        const double copy_ns = bench::measure([&] {
+            const std::map<std::string, int> ordered(data.begin(), data.end());
+            str.clear();
+            pretty::format_to(str, ordered);
+            bench::do_not_optimize(str);
+        });
+        bench::report(name + " / copied into std::map", copy_ns);
+
+        const double sorted_ns = bench::measure([&] {
+            str = pretty::print(data, pretty::sorted_unordered{});
+            bench::do_not_optimize(str);
+        });
+        bench::report(name + " / sorted_unordered", sorted_ns, copy_ns);
+    }
+}
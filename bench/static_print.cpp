@@ -0,0 +1,50 @@
+#include <array>
+#include <pretty_print/pretty_print.hpp>
+#include <string>
+#include <tuple>
+
+#include "bench.hpp"
+
+namespace {
+
+    constexpr std::array<int, 64> make_table() {
+        std::array<int, 64> table{};
+        for (std::size_t i = 0; i < table.size(); ++i) {
+            table[i] = static_cast<int>(i * i * 31);
+        }
+        return table;
+    }
+
+    constexpr std::array<int, 64> table = make_table();
+    constexpr auto config = std::make_tuple("service", 8080, std::make_pair("threads", 16), true);
+
+}  // namespace
+
+void bench_static_print() {
+    std::string str;
+    const double table_ns = bench::measure([&] {
+        str.clear();
+        pretty::format_to(str, table);
+        bench::do_not_optimize(str);
+    });
+    bench::report("array<int, 64> / format_to", table_ns);
+
+    const double static_table_ns = bench::measure([&] {
+        str.assign(pretty::static_print<table>().view());
+        bench::do_not_optimize(str);
+    });
+    bench::report("array<int, 64> / static_print", static_table_ns, table_ns);
+
+    const double config_ns = bench::measure([&] {
+        str.clear();
+        pretty::format_to(str, config);
+        bench::do_not_optimize(str);
+    });
+    bench::report("tuple config / format_to", config_ns);
+
+    const double static_config_ns = bench::measure([&] {
+        str.assign(pretty::static_print<config>().view());
+        bench::do_not_optimize(str);
+    });
+    bench::report("tuple config / static_print", static_config_ns, config_ns);
+}
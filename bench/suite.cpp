@@ -0,0 +1,233 @@
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <pretty_print/pretty_print.hpp>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+#include "bench.hpp"
+#include "suite.hpp"
+
+namespace {
+
+    struct result {
+        std::string type;
+        std::size_t size;
+        std::string method;
+        double ns;
+        std::size_t bytes;
+        std::size_t allocations;
+    };
+
+    /** every case is printed three ways: into a stream, into a returned string, and by a hand-written loop */
+    class suite {
+    public:
+        explicit suite(const bench::suite_options& options) : options_(options) {}
+
+        template <class T, class HandWritten>
+        void run(const std::string& type, std::size_t size, const T& data, HandWritten hand_written) {
+            if (type.find(options_.filter) == std::string::npos) {
+                return;
+            }
+            record(type, size, "print(out, x)", [&] {
+                std::ostringstream out;
+                pretty::print(out, data);
+                return static_cast<std::size_t>(out.tellp());
+            });
+            record(type, size, "print(x)", [&] { return pretty::print(data).size(); });
+            record(type, size, "hand-written", [&] {
+                std::ostringstream out;
+                hand_written(out, data);
+                return static_cast<std::size_t>(out.tellp());
+            });
+        }
+
+        void write_json(std::ostream& out) const {
+            out << "[\n";
+            for (std::size_t i = 0; i < results_.size(); ++i) {
+                const result& r = results_[i];
+                out << "  {\"type\": \"" << r.type << "\", \"size\": " << r.size << ", \"method\": \"" << r.method
+                    << "\", \"ns_per_call\": " << r.ns << ", \"ns_per_element\": " << r.ns / static_cast<double>(r.size)
+                    << ", \"bytes\": " << r.bytes << ", \"bytes_per_second\": " << bytes_per_second(r)
+                    << ", \"allocations_per_call\": " << r.allocations << '}' << (i + 1 == results_.size() ? "\n" : ",\n");
+            }
+            out << "]\n";
+        }
+
+    private:
+        static double bytes_per_second(const result& r) { return static_cast<double>(r.bytes) * 1e9 / r.ns; }
+
+        template <class F>
+        void record(const std::string& type, std::size_t size, const std::string& method, F fn) {
+            const std::size_t before = bench::allocations();
+            const std::size_t bytes = fn();
+            const std::size_t allocations = bench::allocations() - before;
+            const double ns = bench::measure([&] { bench::do_not_optimize(fn()); }, options_.min_time);
+            results_.push_back({type, size, method, ns, bytes, allocations});
+            std::cout << std::left << std::setw(44) << type + " x " + std::to_string(size) << std::setw(16) << method
+                      << std::right << std::fixed << std::setprecision(2) << std::setw(12)
+                      << ns / static_cast<double>(size) << " ns/elem" << std::setw(10) << std::setprecision(0)
+                      << bytes_per_second(results_.back()) / 1e6 << " MB/s" << std::setw(10) << allocations
+                      << " allocs\n";
+        }
+
+        const bench::suite_options& options_;
+        std::vector<result> results_;
+    };
+
+    /** the loop people write instead of pretty::print, element text written by print_element */
+    template <class T, class PrintElement>
+    void hand_written_range(std::ostream& out, const T& data, PrintElement print_element) {
+        out << '[';
+        const char* delimiter = "";
+        for (const auto& el : data) {
+            out << delimiter;
+            print_element(out, el);
+            delimiter = ", ";
+        }
+        out << ']';
+    }
+
+    template <std::size_t N>
+    void run_c_array(suite& cases, std::size_t max_size) {
+        if (N > max_size) {
+            return;
+        }
+        std::unique_ptr<int[][N]> storage(new int[1][N]);
+        int(&data)[N] = storage[0];
+        for (std::size_t i = 0; i < N; ++i) {
+            data[i] = static_cast<int>(i * 7919 % 1000003);
+        }
+        cases.run("int[N]", N, data, [](std::ostream& out, const int(&arr)[N]) {
+            hand_written_range(out, arr, [](std::ostream& o, int el) { o << el; });
+        });
+    }
+
+}  // namespace
+
+void bench::run_suite(const suite_options& options) {
+    suite cases(options);
+    for (const std::size_t size : {std::size_t{10}, std::size_t{1000}, std::size_t{100000}, std::size_t{1000000},
+                                   std::size_t{10000000}}) {
+        if (size > options.max_size) {
+            break;
+        }
+        const auto number = [](std::ostream& out, const auto& el) { out << el; };
+        const auto quoted = [](std::ostream& out, const std::string& el) { out << std::quoted(el); };
+
+        std::vector<int> ints(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            ints[i] = static_cast<int>(i * 7919 % 1000003) - 500000;
+        }
+        cases.run("vector<int>", size, ints,
+                  [&](std::ostream& out, const std::vector<int>& data) { hand_written_range(out, data, number); });
+        ints = {};
+
+        std::vector<double> doubles(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            doubles[i] = static_cast<double>(i) / 7;
+        }
+        cases.run("vector<double>", size, doubles,
+                  [&](std::ostream& out, const std::vector<double>& data) { hand_written_range(out, data, number); });
+        doubles = {};
+
+        std::vector<std::string> strings(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            strings[i] = "item_" + std::to_string(i);
+        }
+        cases.run("vector<string>", size, strings,
+                  [&](std::ostream& out, const std::vector<std::string>& data) { hand_written_range(out, data, quoted); });
+        strings = {};
+
+        // size counts the innermost ints: 4 inner maps of 4 ints per outer key
+        std::map<int, std::map<int, std::vector<int>>> nested;
+        for (std::size_t i = 0; i < (size + 15) / 16; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                nested[static_cast<int>(i)][j] = {j, j * 10, j * 100, j * 1000};
+            }
+        }
+        cases.run("map<int, map<int, vector<int>>>", size, nested, [&](std::ostream& out, const auto& data) {
+            out << '{';
+            const char* delimiter = "";
+            for (const auto& [key, inner] : data) {
+                out << delimiter << key << ": {";
+                const char* inner_delimiter = "";
+                for (const auto& [inner_key, values] : inner) {
+                    out << inner_delimiter << inner_key << ": ";
+                    hand_written_range(out, values, number);
+                    inner_delimiter = ", ";
+                }
+                out << '}';
+                delimiter = ", ";
+            }
+            out << '}';
+        });
+        nested = {};
+
+        std::vector<std::tuple<int, std::string, double>> tuples(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            tuples[i] = {static_cast<int>(i), "t" + std::to_string(i % 100), static_cast<double>(i) / 3};
+        }
+        cases.run("vector<tuple<int, string, double>>", size, tuples, [&](std::ostream& out, const auto& data) {
+            hand_written_range(out, data, [](std::ostream& o, const auto& el) {
+                o << '(' << std::get<0>(el) << ", " << std::quoted(std::get<1>(el)) << ", " << std::get<2>(el) << ')';
+            });
+        });
+        tuples = {};
+
+        std::vector<std::variant<int, std::string>> variants(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            if (i % 2 == 0) {
+                variants[i] = static_cast<int>(i);
+            } else {
+                variants[i] = "v" + std::to_string(i % 100);
+            }
+        }
+        cases.run("vector<variant<int, string>>", size, variants, [&](std::ostream& out, const auto& data) {
+            hand_written_range(out, data, [](std::ostream& o, const auto& el) {
+                if (const int* value = std::get_if<int>(&el)) {
+                    o << *value;
+                } else {
+                    o << std::quoted(std::get<std::string>(el));
+                }
+            });
+        });
+        variants = {};
+
+        std::vector<std::optional<int>> optionals(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            if (i % 3 != 0) {
+                optionals[i] = static_cast<int>(i);
+            }
+        }
+        cases.run("vector<optional<int>>", size, optionals, [&](std::ostream& out, const auto& data) {
+            hand_written_range(out, data, [](std::ostream& o, const std::optional<int>& el) {
+                if (el) {
+                    o << *el;
+                } else {
+                    o << "null";
+                }
+            });
+        });
+        optionals = {};
+    }
+
+    run_c_array<10>(cases, options.max_size);
+    run_c_array<1000>(cases, options.max_size);
+    run_c_array<100000>(cases, options.max_size);
+    run_c_array<1000000>(cases, options.max_size);
+    run_c_array<10000000>(cases, options.max_size);
+
+    if (!options.json.empty()) {
+        std::ofstream out(options.json);
+        cases.write_json(out);
+        std::cout << "results written to " << options.json << '\n';
+    }
+}
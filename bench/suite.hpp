@@ -0,0 +1,20 @@
+#pragma once
+#include <chrono>   // std::chrono::milliseconds
+#include <cstddef>  // std::size_t
+#include <string>   // std::string
+
+namespace bench {
+
+    /** command line of pretty_print_bench --suite */
+    struct suite_options {
+        std::size_t max_size = 1000000;                         ///< --max-size, largest container size, up to 10M
+        std::chrono::milliseconds min_time{200};                ///< --min-time, measuring time per case
+        std::string json;                                       ///< --json, file for the machine-readable results
+        std::string filter;                                     ///< --filter, run only types containing it
+    };
+
+    /** every type at sizes 10, 1000, ... up to max_size printed by print(out, x), print(x) and a hand-written loop,
+     * reporting ns per element, bytes per second and allocations per call */
+    void run_suite(const suite_options& options);
+
+}  // namespace bench
@@ -0,0 +1,45 @@
+#include <cstdlib>
+#include <pretty_print/pretty_print.hpp>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <vector>
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+#include "bench.hpp"
+
+namespace {
+
+    /** print_ti as it was before the type name was taken at compile time */
+    template <class T>
+    std::string print_with_name(std::string_view name, const T& data) {
+        std::string result;
+        result.reserve(name.size() + 1 + pretty::formatted_size(data));
+        result.append(name).append("@");
+        pretty::format_to(result, data);
+        return result;
+    }
+
+}  // namespace
+
+void bench_type_name() {
+    const std::vector<int> data = {1, 2, 3};
+
+    const double mangled_ns = bench::measure([&] { bench::do_not_optimize(print_with_name(typeid(data).name(), data)); });
+    bench::report("vector<int>(3) / print_ti with typeid name", mangled_ns);
+
+#if __has_include(<cxxabi.h>)
+    const double demangle_ns = bench::measure([&] {
+        int status = 0;
+        char* name = abi::__cxa_demangle(typeid(data).name(), nullptr, nullptr, &status);
+        bench::do_not_optimize(print_with_name(name, data));
+        std::free(name);
+    });
+    bench::report("vector<int>(3) / print_ti with __cxa_demangle per call", demangle_ns, mangled_ns);
+#endif
+
+    const double print_ti_ns = bench::measure([&] { bench::do_not_optimize(pretty::print_ti(data)); });
+    bench::report("vector<int>(3) / print_ti", print_ti_ns, mangled_ns);
+}
@@ -0,0 +1,56 @@
+#include <pretty_print/pretty_print.hpp>
+#include <string>
+
+#include "bench.hpp"
+
+namespace {
+
+    template <class CharT>
+    void throughput(const std::string& name, const std::basic_string<CharT>& str) {
+        std::string out;
+        const double ns = bench::measure([&] {
+            out.clear();
+            pretty::format_to(out, str);
+            bench::do_not_optimize(out);
+        });
+        bench::report(name + " / format_to, " + std::to_string(static_cast<int>(str.size() * sizeof(CharT) / ns * 1e3)) +
+                          " MB/s in",
+                      ns);
+    }
+
+    /** the same text as UTF-16 and UTF-32, count code points, every step-th of them taken from wide */
+    template <class String>
+    String text(std::size_t count, std::size_t step, const String& wide) {
+        String str;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (step != 0 && i % step == 0) {
+                str += wide;
+            } else {
+                str += static_cast<typename String::value_type>('a' + i % 26);
+            }
+        }
+        return str;
+    }
+
+}  // namespace
+
+void bench_utf() {
+    constexpr std::size_t size = 1 << 16;
+    throughput("u16string(64k) ASCII", text(size, 0, std::u16string()));
+    throughput("u16string(64k) 1/16 Cyrillic", text(size, 16, std::u16string(u"ж")));
+    throughput("u16string(64k) Cyrillic", text(size, 1, std::u16string(u"ж")));
+    throughput("u16string(64k) 1/16 surrogate pairs", text(size, 16, std::u16string(u"😀")));
+    throughput("u32string(64k) ASCII", text(size, 0, std::u32string()));
+    throughput("u32string(64k) 1/16 Cyrillic", text(size, 16, std::u32string(U"ж")));
+
+    const std::string narrow = text(size, 0, std::string());
+    std::string out;
+    const double ns = bench::measure([&] {
+        out.clear();
+        pretty::format_to(out, narrow);
+        bench::do_not_optimize(out);
+    });
+    bench::report("string(64k) ASCII / format_to, " + std::to_string(static_cast<int>(narrow.size() / ns * 1e3)) +
+                      " MB/s in",
+                  ns);
+}
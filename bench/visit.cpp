@@ -0,0 +1,37 @@
+#include <map>
+#include <pretty_print/pretty_print.hpp>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+void bench_visit() {
+    std::map<std::string, std::vector<int>> data;
+    for (int i = 0; i < 1000; ++i) {
+        data["key_" + std::to_string(i)] = std::vector<int>(16, i * 1000);
+    }
+
+    std::string str;
+    const double text_ns = bench::measure([&] {
+        str.clear();
+        pretty::format_to(str, data);
+        bench::do_not_optimize(str);
+    });
+    bench::report("map<string, vector<int>> / text, " + std::to_string(str.size()) + " bytes", text_ns);
+
+    const double json_ns = bench::measure([&] {
+        str.clear();
+        pretty::json_backend backend(str);
+        pretty::visit(data, backend);
+        bench::do_not_optimize(str);
+    });
+    bench::report("map<string, vector<int>> / json, " + std::to_string(str.size()) + " bytes", json_ns, text_ns);
+
+    const double msgpack_ns = bench::measure([&] {
+        str.clear();
+        pretty::msgpack_backend backend(str);
+        pretty::visit(data, backend);
+        bench::do_not_optimize(str);
+    });
+    bench::report("map<string, vector<int>> / msgpack, " + std::to_string(str.size()) + " bytes", msgpack_ns, text_ns);
+}
@@ -0,0 +1,21 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<std::size_t> allocation_count{0};
+}
+
+/** replaced global allocation functions count every allocation in the program */
+void* operator new(std::size_t size) {
+    ++allocation_count;
+    if (void* ptr = std::malloc(size != 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+std::size_t allocations() { return allocation_count.load(); }
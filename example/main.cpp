@@ -107,6 +107,18 @@ void print_user_data() {
     pretty::print(std::cout, data) << std::endl;
 }
 
+struct point {
+    int x = 1;
+    double y = 2.5;
+    std::string name = "origin";
+    std::vector<int> tags = {1, 2};
+};
+
+void print_aggregate() {
+    std::map<int, point> data = {{1, point{}}};
+    pretty::print(std::cout, data) << std::endl;
+}
+
 #if __has_include(<filesystem>)
 void print_filesystem_path() {
     std::filesystem::path data{"/home/user/data"};
@@ -136,6 +148,7 @@ int main() {
     print_c_array();
     print_hardcore();
     print_user_data();
+    print_aggregate();
 #if __has_include(<filesystem>)
     print_filesystem_path();
 #endif
@@ -1,16 +1,37 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cstdio>
 #if __has_include(<filesystem>)
 #include <filesystem>
 #endif
+#include <forward_list>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <list>
 #include <map>
+#include <memory>
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
 #include <pretty_print/pretty_print.hpp>
+#include <set>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 using namespace std::string_literals;
 
+/** number of operator new calls in the program so far, see allocations.cpp */
+std::size_t allocations();
+
 template <typename T>
 void is_equal_assert(const T& lhs, const T& rhs, int line) {
     if (lhs != rhs) {
@@ -181,6 +202,1122 @@ namespace pretty_test {
         ASSERT_EQUAL(R"(large)"s, ss.str());
         ASSERT_EQUAL(R"(large)"s, pretty::print(data2));
     }
+
+    template <class T>
+    void check_format_to(const T& data) {
+        std::string str = "prefix ";
+        pretty::format_to(str, data);
+        ASSERT_EQUAL("prefix "s + pretty::print(data), str);
+
+        char buf[256];
+        char* end = pretty::format_to(buf, data);
+        ASSERT_EQUAL(pretty::print(data), std::string(buf, end));
+        ASSERT_EQUAL(pretty::print(data).size(), pretty::formatted_size(data));
+
+        std::stringstream ss;
+        pretty::print(ss, data);
+        ASSERT_EQUAL(ss.str(), pretty::print(data));
+    }
+
+    void test_format_to() {
+        check_format_to(std::vector<int>{1, -2, 3, 4});
+        check_format_to(std::map<std::string, std::vector<double>>{{"a\"b", {1.5, -0.1, 1e20}}, {"c\\", {}}});
+        check_format_to(std::make_tuple("1", 2, 3, 4.5, 'c', true, 7u, 1.0f / 3));
+        check_format_to(std::optional<std::string>{});
+        check_format_to(std::variant<int, std::string, int*>{"123"});
+        int data2[2][2][2] = {{{1, 2}, {3, 4}}, {{5, 6}, {7, 8}}};
+        check_format_to(data2);
+        check_format_to("hello");
+        check_format_to(std::vector<user_data>(2));
+        check_format_to(std::vector<size>{size::large, size::small});
+        check_format_to(std::make_pair(std::string_view("key"), std::numeric_limits<long long>::min()));
+        check_format_to(std::vector<std::string_view>{std::string_view(), "x"});
+#if __has_include(<filesystem>)
+        check_format_to(std::filesystem::path{"/home/user/data"});
+#endif
+
+        ASSERT_EQUAL(R"(4.5 "a\"b" {1: 2})"s + " ", pretty::print_args(4.5, "a\"b", std::map<int, int>{{1, 2}}));
+
+        std::string str;
+        pretty::format_to(std::back_inserter(str), std::map<int, int>{{1, 2}, {2, 3}});
+        ASSERT_EQUAL("{1: 2, 2: 3}"s, str);
+    }
+
+    void test_escape() {
+        ASSERT_EQUAL(R"("a\"b\\c")"s, pretty::print("a\"b\\c"s));
+        ASSERT_EQUAL(R"(["tab\there", "line\n", "\x01\x7f"])"s,
+                     pretty::print(std::vector<std::string>{"tab\there", "line\n", "\x01\x7f"}));
+        ASSERT_EQUAL("\"пример €\""s, pretty::print("пример €"s));
+        ASSERT_EQUAL(R"("bad \xff\xc3 and \xed\xa0\x80")"s, pretty::print("bad \xff\xc3 and \xed\xa0\x80"s));
+
+        std::string str(100, 'x');
+        for (std::size_t i = 0; i < str.size(); i += 7) {
+            str[i] = "\"\\\n\x80"[i % 4];
+        }
+        std::string expected = "\"";
+        for (const char c : str) {
+            switch (c) {
+                case '"':
+                    expected += "\\\"";
+                    break;
+                case '\\':
+                    expected += "\\\\";
+                    break;
+                case '\n':
+                    expected += "\\n";
+                    break;
+                case '\x80':
+                    expected += "\\x80";
+                    break;
+                default:
+                    expected += c;
+            }
+        }
+        expected += "\"";
+        for (std::size_t i = 0; i < str.size(); ++i) {
+            const char* last = str.data() + str.size();
+            ASSERT_EQUAL(pretty::detail::find_escape_scalar(str.data() + i, last),
+                         pretty::detail::find_escape()(str.data() + i, last));
+        }
+        check_format_to(str);
+        ASSERT_EQUAL(expected, pretty::print(str));
+
+        std::stringstream ss;
+        ss << std::setw(8) << pretty::detail::quoted_helper("a\"");
+        ASSERT_EQUAL(R"(   "a\"")"s, ss.str());
+    }
+
+    void test_utf() {
+        ASSERT_EQUAL("\"héllo \\\"мир\\\" 😀\\n\""s, pretty::print(u"héllo \"мир\" 😀\n"s));
+        ASSERT_EQUAL("\"€𝄞\""s, pretty::print(U"€𝄞"s));
+        ASSERT_EQUAL("\"wide\""s, pretty::print(L"wide"s));
+        ASSERT_EQUAL(R"({"ключ": ["a", "b"]})"s,
+                     pretty::print(std::map<std::u16string, std::vector<std::u32string_view>>{{u"ключ", {U"a", U"b"}}}));
+        ASSERT_EQUAL(R"(("array", "pointer"))"s,
+                     pretty::print(std::make_tuple(u"array", static_cast<const char32_t*>(U"pointer"))));
+
+        // unpaired surrogates and values past U+10FFFF become U+FFFD
+        ASSERT_EQUAL("\"\uFFFDa\uFFFD\uFFFD\""s, pretty::print(std::u16string{0xd800, u'a', 0xdc00, 0xd83d}));
+        ASSERT_EQUAL("\"\uFFFD\uFFFDz\""s, pretty::print(std::u32string{0x110000, 0xd800, U'z'}));
+
+        // long strings are transcoded in chunks, surrogate pairs and ASCII runs across the chunk boundaries
+        std::u16string str;
+        std::u32string str32;
+        std::string expected = "\"";
+        for (int i = 0; i < 1000; ++i) {
+            if (i % 97 == 0) {
+                str += u"😀";
+                str32 += U"😀";
+                expected += "😀";
+            } else if (i % 13 == 0) {
+                str += u'ж';
+                str32 += U'ж';
+                expected += "ж";
+            } else {
+                str += static_cast<char16_t>('a' + i % 26);
+                str32 += static_cast<char32_t>('a' + i % 26);
+                expected += static_cast<char>('a' + i % 26);
+            }
+        }
+        expected += "\"";
+        ASSERT_EQUAL(expected, pretty::print(str));
+        ASSERT_EQUAL(expected, pretty::print(str32));
+        check_format_to(std::u16string(u"жёлтый 😀 \t"));
+        check_format_to(std::u32string(U"жёлтый 😀 \t"));
+    }
+
+    void test_numbers() {
+        std::vector<int> ints(3000);
+        for (std::size_t i = 0; i < ints.size(); ++i) {
+            ints[i] = static_cast<int>(i * 7919) - 1000000;
+        }
+        ints[0] = std::numeric_limits<int>::min();
+        ints[1] = std::numeric_limits<int>::max();
+        std::string expected = "[";
+        for (std::size_t i = 0; i < ints.size(); ++i) {
+            expected += (i == 0 ? "" : ", ") + std::to_string(ints[i]);
+        }
+        expected += "]";
+        ASSERT_EQUAL(expected, pretty::print(ints));
+        check_format_to(std::vector<int>{});
+        check_format_to(std::array<unsigned long long, 3>{0, 9, std::numeric_limits<unsigned long long>::max()});
+        check_format_to(std::array<float, 4>{0.1f, -2.5f, 1e-7f, 3e38f});
+        double doubles[] = {0.0, -0.5, 1.0 / 3, 1e100, 123456789.0};
+        check_format_to(doubles);
+
+        std::vector<double> large(1000, 1.0 / 7);
+        std::stringstream ss;
+        pretty::print(ss, large);
+        ASSERT_EQUAL(ss.str(), pretty::print(large));
+
+        ss = std::stringstream();
+        ss << std::hex << std::setprecision(3);
+        pretty::print(ss, std::vector<int>{255, 16});
+        pretty::print(ss, std::vector<double>{1.0 / 3});
+        ASSERT_EQUAL("[ff, 10][0.333]"s, ss.str());
+    }
+
+    void test_limits() {
+        std::vector<int> ints(10000000);
+        pretty::limits items;
+        items.max_items = 3;
+        ASSERT_EQUAL("[0, 0, 0, ... (+9999997 more)]"s, pretty::print(ints, items));
+        ASSERT_EQUAL("[1, 2]"s, pretty::print(std::vector<int>{1, 2}, items));
+        ASSERT_EQUAL("[1: 2, ...]"s, pretty::print(std::forward_list<std::pair<int, int>>{{1, 2}, {3, 4}},
+                                                    pretty::limits{1}));
+
+        std::map<std::string, std::vector<std::vector<int>>> nested = {{"a", {{1, 2}, {}}}, {"b", {}}};
+        pretty::limits depth;
+        depth.max_depth = 2;
+        ASSERT_EQUAL(R"({"a": [[...], []], "b": []})"s, pretty::print(nested, depth));
+        depth.max_depth = 0;
+        ASSERT_EQUAL("{...}"s, pretty::print(nested, depth));
+
+        pretty::limits bytes;
+        bytes.max_bytes = 12;
+        ASSERT_EQUAL("[0, 0, 0, 0,..."s, pretty::print(ints, bytes));
+        ASSERT_EQUAL(R"({"a": [[1, 2...)"s, pretty::print(nested, bytes));
+        bytes.max_bytes = 100;
+        ASSERT_EQUAL(pretty::print(nested), pretty::print(nested, bytes));
+
+        // long strings are escaped only up to the cut, the text is the same as cutting the whole print
+        std::string text = "a\"b";
+        std::u16string wide = u"a\"b";
+        for (int i = 0; i < 100000; ++i) {
+            text += i % 3 ? "\xd0\xb6" : "\n\xff";
+            wide += i % 3 ? u"\U0001F600" : u"\n";
+        }
+        const auto strings = std::make_pair(text, wide);
+        const std::string full = pretty::print(strings);
+        for (std::size_t max = 0; max != 40; ++max) {
+            bytes.max_bytes = max;
+            ASSERT_EQUAL(full.substr(0, max) + "...", pretty::print(strings, bytes));
+        }
+        bytes.max_bytes = text.size() + 10;
+        ASSERT_EQUAL(full.substr(0, bytes.max_bytes) + "...", pretty::print(strings, bytes));
+
+        std::stringstream ss;
+        pretty::print(ss, std::make_tuple(ints, "str"), items) << '!';
+        ASSERT_EQUAL(R"(([0, 0, 0, ... (+9999997 more)], "str")!)"s, ss.str());
+    }
+
+    std::string read_file(std::FILE* file) {
+        std::string str;
+        std::rewind(file);
+        char buf[4096];
+        for (std::size_t n; (n = std::fread(buf, 1, sizeof(buf), file)) > 0;) {
+            str.append(buf, n);
+        }
+        return str;
+    }
+
+    void test_sink() {
+        const std::map<std::string, std::vector<int>> data = {{"a", {1, 2}}, {"b\"", {}}};
+        const std::string large(1000, 'x');
+        std::FILE* file = std::tmpfile();
+        std::fputs("stdio ", file);
+        {
+            pretty::file_sink out(file, 64);
+            pretty::print(out, data);
+            pretty::print_line(out, 1, "two", 3.5);
+            pretty::print_args(out, large, std::vector<double>(100, 0.5));
+            ASSERT_EQUAL(true, out.flush());
+            pretty::print(out, std::make_tuple(large, 'c'), pretty::limits{});
+            pretty::print(out, std::string_view());
+        }
+        ASSERT_EQUAL("stdio "s + pretty::print(data) + R"(1 "two" 3.5 )" + "\n" +
+                         pretty::print_args(large, std::vector<double>(100, 0.5)) +
+                         pretty::print(std::make_tuple(large, 'c')) + R"("")",
+                     read_file(file));
+        std::fclose(file);
+    }
+
+    void test_parallel() {
+        std::vector<std::map<std::string, double>> data(5000);
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            data[i]["key \"" + std::to_string(i)] = static_cast<double>(i) / 3;
+        }
+        const std::string expected = pretty::print(data);
+        for (std::size_t threads : {0, 1, 2, 3, 8}) {
+            std::stringstream ss;
+            pretty::parallel_print(ss, data, threads);
+            ASSERT_EQUAL(expected, ss.str());
+        }
+
+        std::string str;
+        {
+            pretty::detail::string_writer<std::string> out(str);
+            pretty::parallel_print(out, data, 4);
+        }
+        ASSERT_EQUAL(expected, str);
+
+        static int ints[3000];
+        std::stringstream ss;
+        pretty::parallel_print(ss, ints, 4);
+        ASSERT_EQUAL(pretty::print(ints), ss.str());
+        ss = std::stringstream();
+        pretty::parallel_print(ss, std::vector<int>{1, 2}, 4);
+        ASSERT_EQUAL("[1, 2]"s, ss.str());
+        ss = std::stringstream();
+        pretty::parallel_print(ss, std::string(5000, 'a'), 4);
+        ASSERT_EQUAL(pretty::print(std::string(5000, 'a')), ss.str());
+
+        // the chunks are formatted in the default state, streams with other flags are printed serially
+        const std::vector<std::pair<bool, int>> flags(5000, {true, 1});
+        std::stringstream serial;
+        serial << std::boolalpha;
+        pretty::print(serial, flags);
+        ss = std::stringstream();
+        ss << std::boolalpha;
+        pretty::parallel_print(ss, flags, 4);
+        ASSERT_EQUAL("[true: 1, true: 1"s, ss.str().substr(0, 17));
+        ASSERT_EQUAL(serial.str(), ss.str());
+    }
+
+    /** copying it into the queue of an async_printer throws */
+    struct throwing_copy {
+        throwing_copy() = default;
+        throwing_copy(const throwing_copy&) { throw std::runtime_error("copy"); }
+    };
+
+    std::ostream& operator<<(std::ostream& out, const throwing_copy&) { return out << "copied"; }
+
+    void test_async() {
+        std::string expected;
+        for (int i = 0; i < 100; ++i) {
+            expected += pretty::print_args(int{i}, "str", std::vector<int>{i}) + "\n";
+        }
+        for (const auto policy : {pretty::overflow_policy::block, pretty::overflow_policy::grow}) {
+            std::stringstream ss;
+            {
+                pretty::async_printer<std::stringstream> out(ss, 4, policy);
+                for (int i = 0; i < 100; ++i) {
+                    char str[] = "str";
+                    ASSERT_EQUAL(true, out.print_line(i, str, std::vector<int>{i}));
+                }
+                out.flush();
+                ASSERT_EQUAL(expected, ss.str());
+                out.print_args(std::map<int, int>{{1, 2}}, std::string(200, 'a'));
+            }
+            ASSERT_EQUAL(expected + pretty::print_args(std::map<int, int>{{1, 2}}, std::string(200, 'a')), ss.str());
+        }
+
+        std::stringstream ss;
+        pretty::async_printer<std::stringstream> out(ss, 2, pretty::overflow_policy::drop);
+        std::size_t printed = 0;
+        for (int i = 0; i < 1000; ++i) {
+            printed += out.print_line(i);
+        }
+        out.shutdown();
+        ASSERT_EQUAL(false, out.print_line(0));
+        ASSERT_EQUAL(std::size_t{1001}, printed + out.dropped());
+        const std::string lines = ss.str();
+        ASSERT_EQUAL(static_cast<std::ptrdiff_t>(printed), std::count(lines.begin(), lines.end(), '\n'));
+
+        std::vector<std::thread> threads;
+        ss = std::stringstream();
+        {
+            pretty::async_printer<std::stringstream> shared(ss, 16, pretty::overflow_policy::grow);
+            for (int t = 0; t < 4; ++t) {
+                threads.emplace_back([&shared, t] {
+                    for (int i = 0; i < 1000; ++i) {
+                        shared.print_line(t, i);
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+        std::map<int, int> next;
+        for (int t, i; ss >> t >> i;) {
+            ASSERT_EQUAL(next[t]++, i);
+        }
+        ASSERT_EQUAL("{0: 1000, 1: 1000, 2: 1000, 3: 1000}"s, pretty::print(next));
+
+        // views are copied, their source may be gone before the background thread prints them
+        ss = std::stringstream();
+        {
+            pretty::async_printer<std::stringstream> views(ss);
+            {
+                std::string source(100, 'v');
+                std::u16string wide(50, u'w');
+                views.print_line(std::string_view(source), std::u16string_view(wide));
+                source.assign(100, 'x');
+            }
+        }
+        ASSERT_EQUAL('"' + std::string(100, 'v') + "\" \"" + std::string(50, 'w') + "\" \n", ss.str());
+
+        // a record whose arguments throw while being queued is skipped, the records after it are printed
+        ss = std::stringstream();
+        {
+            pretty::async_printer<std::stringstream> throwing(ss, 2, pretty::overflow_policy::block);
+            for (int i = 0; i < 3; ++i) {
+                bool thrown = false;
+                try {
+                    throwing.print_line(i, throwing_copy{});
+                } catch (const std::runtime_error&) {
+                    thrown = true;
+                }
+                ASSERT_EQUAL(true, thrown);
+                throwing.print_line(i);
+            }
+            throwing.flush();
+            ASSERT_EQUAL("0 \n1 \n2 \n"s, ss.str());
+        }
+
+        // records pushed while shutdown runs are either printed or counted as dropped, blocked producers return
+        for (int round = 0; round < 20; ++round) {
+            ss = std::stringstream();
+            std::atomic<std::size_t> accepted{0};
+            pretty::async_printer<std::stringstream> racing(ss, 2, pretty::overflow_policy::block);
+            threads.clear();
+            for (int t = 0; t < 2; ++t) {
+                threads.emplace_back([&racing, &accepted] {
+                    for (int i = 0; i < 200; ++i) {
+                        accepted += racing.print_line(i);
+                    }
+                });
+            }
+            racing.shutdown();
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            const std::string text = ss.str();
+            ASSERT_EQUAL(static_cast<std::ptrdiff_t>(accepted.load()), std::count(text.begin(), text.end(), '\n'));
+            ASSERT_EQUAL(std::size_t{400}, accepted.load() + racing.dropped());
+        }
+    }
+
+    struct counted {
+        int& prints;
+    };
+
+    std::ostream& operator<<(std::ostream& out, const counted& data) {
+        ++data.prints;
+        return out << "counted";
+    }
+
+    void test_lazy() {
+        int prints = 0;
+        const counted data{prints};
+        auto view = pretty::lazy(data);
+        auto args = pretty::lazy_args(data, 1, std::vector<int>{2, 3});
+        ASSERT_EQUAL(0, prints);
+
+        std::stringstream ss;
+        ss << view;
+        ASSERT_EQUAL("counted"s, ss.str());
+        ASSERT_EQUAL(1, prints);
+        ASSERT_EQUAL("counted 1 [2, 3] "s, pretty::print(args));
+        ASSERT_EQUAL(R"(({1: 2}, "a"))"s,
+                     pretty::print(std::make_tuple(pretty::lazy(std::map<int, int>{{1, 2}}), pretty::lazy("a"))));
+        std::vector<pretty::lazy_view<std::vector<int>>> views;
+        views.push_back(pretty::lazy(std::vector<int>{1, 2}));
+        ASSERT_EQUAL("[[1, 2]]"s, pretty::print(views));
+
+        ss = std::stringstream();
+        pretty::print_line(ss, pretty::lazy(std::vector<int>{1}), pretty::lazy_args("x", 2.5));
+        ASSERT_EQUAL(R"([1] "x" 2.5  )"s + "\n", ss.str());
+
+        // nested views print at their depth, as the values they hold
+        const std::vector<std::vector<std::vector<int>>> eager = {{{1}, {2, 3}}};
+        std::vector<pretty::lazy_view<const std::vector<std::vector<int>>&>> nested;
+        nested.push_back(pretty::lazy(eager[0]));
+        pretty::limits depth;
+        depth.max_depth = 1;
+        ASSERT_EQUAL("[[...]]"s, pretty::print(nested, depth));
+        ASSERT_EQUAL(pretty::print(eager, pretty::indent{}), pretty::print(nested, pretty::indent{}));
+        std::vector<decltype(pretty::lazy_args(eager))> nested_args;
+        nested_args.push_back(pretty::lazy_args(eager));
+        std::string expected = pretty::print(std::vector<std::vector<std::vector<std::vector<int>>>>{eager},
+                                             pretty::indent{});
+        expected.insert(expected.size() - 2, " ");
+        ASSERT_EQUAL(expected, pretty::print(nested_args, pretty::indent{}));
+    }
+
+    void test_allocations() {
+        const std::map<std::string, std::vector<int>> data = {{"a very long key that is not a small string", {1, 2}},
+                                                              {"b", {3}}};
+        const std::string expected = pretty::print(data);
+        ASSERT_EQUAL(std::string_view(expected), pretty::print_view(data));
+
+        const std::string expected_args = expected + " 42 ";
+        ASSERT_EQUAL(std::string_view(expected_args), pretty::print_args_view(data, 42));
+        std::size_t before = allocations();
+        for (int i = 0; i < 100; ++i) {
+            ASSERT_EQUAL(std::string_view(expected), pretty::print_view(data));
+            ASSERT_EQUAL(std::string_view(expected_args), pretty::print_args_view(data, 42));
+        }
+        ASSERT_EQUAL(before, allocations());
+
+        // sized first, then written into the reserved string: one allocation with the default allocator
+        const std::vector<std::string> strings(100, "a string too long for the small string buffer");
+        std::map<std::string, int> large;
+        for (int i = 0; i < 1000; ++i) {
+            large.emplace(std::to_string(i) + " is a key too long for the small string buffer", i);
+        }
+        for (const std::size_t count : {3, 10, 100, 1000}) {
+            const std::map<std::string, int> part(large.begin(), std::next(large.begin(), count));
+            before = allocations();
+            const std::string text = pretty::print(part);
+            ASSERT_EQUAL(before + 1, allocations());
+            const std::string text_ti = pretty::print_ti(part);
+            ASSERT_EQUAL(before + 2, allocations());
+            const std::string text_args = pretty::print_args(part, strings);
+            ASSERT_EQUAL(before + 3, allocations());
+        }
+        before = allocations();
+        const std::string text = pretty::print(strings);
+        ASSERT_EQUAL(before + 1, allocations());
+
+#if __has_include(<memory_resource>)
+        const std::string expected_ti = pretty::print_ti(data);
+        char buffer[1024];
+        before = allocations();
+        for (int i = 0; i < 100; ++i) {
+            std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+            ASSERT_EQUAL(std::string_view(expected), std::string_view(pretty::print(data, &arena)));
+            ASSERT_EQUAL(std::string_view(expected_ti), std::string_view(pretty::print_ti(data, &arena)));
+        }
+        ASSERT_EQUAL(before, allocations());
+#endif
+    }
+
+    void test_print_ti() {
+        static_assert(pretty::detail::type_name<int>() == "int");
+        ASSERT_EQUAL("int@42"s, pretty::print_ti(42));
+        ASSERT_EQUAL("std::vector<int>@[1, 2]"s, pretty::print_ti(std::vector<int>{1, 2}));
+        std::stringstream ss;
+        pretty::print_ti(ss, 'x');
+        ASSERT_EQUAL("char@x"s, ss.str());
+    }
+
+    /** checks in its operator<< that the stream the caller passed still writes to its own streambuf */
+    struct rdbuf_probe {
+        const std::ostream* caller;
+        const std::streambuf* buf;
+    };
+
+    std::ostream& operator<<(std::ostream& out, const rdbuf_probe& probe) {
+        return out << (probe.caller->rdbuf() == probe.buf ? "untouched" : "swapped");
+    }
+
+    /** printed in the unit stored in the iword of the stream, as set by the unit manipulator */
+    struct length {
+        int value;
+    };
+
+    int length_unit() {
+        static const int index = std::ios_base::xalloc();
+        return index;
+    }
+
+    std::ostream& operator<<(std::ostream& out, const length& data) {
+        return out << data.value << (out.iword(length_unit()) != 0 ? "mm" : "m");
+    }
+
+    /** streambuf of a full device: every write fails */
+    class failing_streambuf : public std::streambuf {
+    protected:
+        int_type overflow(int_type) override { return traits_type::eof(); }
+        std::streamsize xsputn(const char*, std::streamsize) override { return 0; }
+    };
+
+    /** the print calls leave the caller's stream as writing to it directly would: formatted by its iword and
+     * throwing the failure its exception mask asks for */
+    void check_stream_state() {
+        std::stringstream ss;
+        ss.iword(length_unit()) = 1;
+        pretty::print_line(ss, std::vector<length>{{1}, {2}}, length{3});
+        ASSERT_EQUAL("[1mm, 2mm] 3mm \n"s, ss.str());
+
+        failing_streambuf full;
+        std::ostream out(&full);
+        out.exceptions(std::ios_base::badbit);
+        bool thrown = false;
+        try {
+            pretty::print(out, 42);
+        } catch (const std::ios_base::failure&) {
+            thrown = true;
+        }
+        ASSERT_EQUAL(true, thrown);
+        ASSERT_EQUAL(true, out.bad());
+    }
+
+    pretty::print_record last_record{};
+    std::size_t records = 0;
+
+#if defined(PRETTY_PRINT_INSTRUMENTATION)
+    void test_instrumentation() {
+        static_assert(pretty::instrumentation::enabled, "example_instrumented defines PRETTY_PRINT_INSTRUMENTATION");
+        pretty::instrumentation::callback([](const pretty::print_record& record) {
+            last_record = record;
+            ++records;
+        });
+        pretty::instrumentation::allocation_counter(&allocations);
+        pretty::instrumentation::reset_thread_stats();
+
+        const std::vector<std::vector<int>> data = {{1, 2, 3}, {4}};
+        std::stringstream ss;
+        {
+            const pretty::print_label label("matrix");
+            pretty::print(ss, data);
+        }
+        ASSERT_EQUAL("matrix"s, std::string(last_record.label));
+        ASSERT_EQUAL(std::size_t{1}, last_record.stats.calls);
+        ASSERT_EQUAL(ss.str().size(), last_record.stats.bytes);
+        ASSERT_EQUAL(std::size_t{7}, last_record.stats.elements);
+        ASSERT_EQUAL(std::size_t{2}, last_record.stats.max_depth);
+        ss << " and more";
+        ASSERT_EQUAL("[[1, 2, 3], [4]] and more"s, ss.str());
+
+        // the print calls inside print_line are one top-level call
+        const std::size_t before = records;
+        const std::size_t size = ss.str().size();
+        pretty::print_line(ss, 1, "two", std::make_tuple(3));
+        ASSERT_EQUAL(before + 1, records);
+        ASSERT_EQUAL(true, last_record.label == nullptr);
+        ASSERT_EQUAL(ss.str().size() - size, last_record.stats.bytes);
+
+        // sized first, the sizing pass is not counted
+        const std::size_t allocated = allocations();
+        const std::string str = pretty::print(data);
+        ASSERT_EQUAL(str.size(), last_record.stats.bytes);
+        ASSERT_EQUAL(std::size_t{7}, last_record.stats.elements);
+        ASSERT_EQUAL(allocations() - allocated, last_record.stats.allocations);
+        ASSERT_EQUAL(std::size_t{3}, pretty::instrumentation::thread_stats().calls);
+        // " and more" was written past pretty
+        ASSERT_EQUAL(ss.str().size() - 9 + str.size(), pretty::instrumentation::thread_stats().bytes);
+        pretty::instrumentation::reset_thread_stats();
+        ASSERT_EQUAL(std::size_t{0}, pretty::instrumentation::thread_stats().calls);
+
+        // threads printing to a shared stream do not race on it: the call writes through a stream of its own
+        std::stringstream shared;
+        pretty::print_line(shared, rdbuf_probe{&shared, shared.rdbuf()}, 1);
+        ASSERT_EQUAL("untouched 1 \n"s, shared.str());
+        ASSERT_EQUAL(shared.str().size(), last_record.stats.bytes);
+        shared = std::stringstream();
+        shared << std::boolalpha << std::setw(8);
+        pretty::print(shared, true) << 2;
+        ASSERT_EQUAL("    true2"s, shared.str());
+        check_stream_state();
+
+        pretty::instrumentation::callback(nullptr);
+        pretty::instrumentation::allocation_counter(nullptr);
+    }
+#else
+    void test_instrumentation() {
+        static_assert(!pretty::instrumentation::enabled);
+        pretty::instrumentation::callback([](const pretty::print_record& record) {
+            last_record = record;
+            ++records;
+        });
+        pretty::instrumentation::reset_thread_stats();
+
+        // the hooks are empty: nothing is recorded and the output is the same
+        std::stringstream ss;
+        {
+            const pretty::print_label label("matrix");
+            pretty::print_line(ss, std::vector<int>{1, 2}, rdbuf_probe{&ss, ss.rdbuf()});
+        }
+        ASSERT_EQUAL("[1, 2] untouched \n"s, ss.str());
+        ASSERT_EQUAL(std::size_t{0}, records);
+        ASSERT_EQUAL(std::size_t{0}, pretty::instrumentation::thread_stats().calls);
+        check_stream_state();
+
+        pretty::instrumentation::callback(nullptr);
+    }
+#endif
+
+    void test_indent() {
+        const std::map<std::string, std::vector<std::vector<int>>> data = {{"a", {{1, 2}, {}}}, {"b", {}}};
+        ASSERT_EQUAL(R"({
+  "a": [
+    [
+      1,
+      2
+    ],
+    []
+  ],
+  "b": []
+})"s,
+                     pretty::print(data, pretty::indent{}));
+
+        pretty::indent layout;
+        layout.width = 4;
+        layout.inline_width = 6;
+        ASSERT_EQUAL(R"({
+    "a": [
+        [1, 2],
+        []
+    ],
+    "b": []
+})"s,
+                     pretty::print(data, layout));
+        layout.inline_width = 100;
+        ASSERT_EQUAL(pretty::print(data), pretty::print(data, layout));
+
+        std::vector<int> deep = {1};
+        std::stringstream ss;
+        pretty::print(ss, std::make_tuple(std::vector<std::vector<std::vector<std::vector<std::vector<int>>>>>{{{{deep}}}},
+                                          "x"),
+                      pretty::indent{20, 0});
+        ASSERT_EQUAL(std::string("([\n") + std::string(20, ' ') + "[\n" + std::string(40, ' ') + "[\n" +
+                         std::string(60, ' ') + "[\n" + std::string(80, ' ') + "[\n" + std::string(100, ' ') + "1\n" +
+                         std::string(80, ' ') + "]\n" + std::string(60, ' ') + "]\n" + std::string(40, ' ') + "]\n" +
+                         std::string(20, ' ') + "]\n]" + R"(, "x"))",
+                     ss.str());
+    }
+
+    template <class T>
+    void check_visit(const T& data) {
+        std::stringstream ss;
+        pretty::text_backend<std::stringstream> backend(ss);
+        pretty::visit(data, backend);
+        ASSERT_EQUAL(pretty::print(data), ss.str());
+    }
+
+    void test_visit() {
+        check_visit(std::map<std::string, std::vector<double>>{{"a\"b", {1.5, -0.1, 1e20}}, {"c\\", {}}});
+        check_visit(std::make_tuple("1", 2, 3, 4.5, 'c', true, 7u, 1.0f / 3));
+        check_visit(std::make_pair(std::optional<int>{}, std::variant<int, std::string, int*>{"123"}));
+        int data2[2][2][2] = {{{1, 2}, {3, 4}}, {{5, 6}, {7, 8}}};
+        check_visit(data2);
+        check_visit("hello");
+        check_visit(std::vector<user_data>(2));
+        check_visit(std::vector<size>{size::large, size::small});
+        check_visit(std::forward_list<std::pair<int, int>>{{1, 2}, {3, 4}});
+        enum class color { red, green, blue };
+        check_visit(std::vector<color>{color::blue});
+
+        const std::map<std::string, std::vector<double>> doubles = {{"a\"b", {1.5, -0.1, 1e20}}, {"c\\", {}}};
+        ASSERT_EQUAL(R"({"a\"b":[1.5,-0.1,1e+20],"c\\":[]})"s, pretty::to_json(doubles));
+        ASSERT_EQUAL("[0.1,-2.5,3e+38]"s, pretty::to_json(std::vector<float>{0.1f, -2.5f, 3e38f}));
+        const std::map<int, std::pair<bool, std::optional<char>>> pairs = {{1, {true, {}}}, {2, {false, 'x'}}};
+        ASSERT_EQUAL(R"({"1":[true,null],"2":[false,"x"]})"s, pretty::to_json(pairs));
+        ASSERT_EQUAL(R"({"[1,\"k\"]":"hello, 42"})"s,
+                     pretty::to_json(std::map<std::tuple<int, std::string>, user_data>{{{1, "k"}, {}}}));
+        ASSERT_EQUAL("[\"\\u0001\\n\xef\xbf\xbd\",null,-5]"s,
+                     pretty::to_json(std::make_tuple("\x01\n\xff"s, std::numeric_limits<double>::infinity(), -5)));
+
+        ASSERT_EQUAL("\x82\xa1" "a\x93\x01\xcd\x01\x00\xd0\x80\xa1" "b\x92\xc3\xcb\x3f\xf8\0\0\0\0\0\0"s,
+                     pretty::to_msgpack(std::map<std::string, std::variant<std::vector<int>, std::pair<bool, double>>>{
+                         {"a", std::vector<int>{1, 256, -128}}, {"b", std::make_pair(true, 1.5)}}));
+        ASSERT_EQUAL("\xdc\x00\x10"s + std::string(16, '\xc0'),
+                     pretty::to_msgpack(std::vector<std::optional<int>>(16)));
+        ASSERT_EQUAL("\xd9\x20"s + std::string(32, 'a'), pretty::to_msgpack(std::string(32, 'a')));
+    }
+
+    struct point {
+        int x = 1;
+        double y = 2.5;
+        std::string name = "origin";
+        std::vector<int> tags = {1, 2};
+    };
+
+    struct line {
+        point from;
+        point to;
+        std::optional<size> kind;
+        user_data data;
+    };
+
+    struct empty {};
+
+    struct with_base : point {
+        int z;
+    };
+
+    struct with_array {
+        int xy[2];
+        long z;
+    };
+
+    struct seventeen {
+        int a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p, q;
+    };
+
+    struct point_2d {
+        std::array<int, 2> xy;
+        long z;
+    };
+
+    enum class level { low, high };
+
+    void test_aggregate() {
+        static_assert(pretty::detail::field_count<point>() == 4, "test failed");
+        static_assert(pretty::detail::field_count<line>() == 4, "test failed");
+        static_assert(pretty::detail::field_count<empty>() == 0, "test failed");
+        // not decomposable into field_count fields: rejected by the trait, not by an error in tie_fields
+        static_assert(pretty::detail::is_plain_aggregate_v<point_2d>, "test failed");
+        static_assert(!pretty::detail::is_plain_aggregate_v<with_base>, "test failed");
+        static_assert(!pretty::detail::is_plain_aggregate_v<with_array>, "test failed");
+        static_assert(!pretty::detail::is_plain_aggregate_v<seventeen>, "test failed");
+
+        ASSERT_EQUAL(R"({1, 2.5, "origin", [1, 2]})"s, pretty::print(point{}));
+        const line data{{}, {-1, 0, "a\"b", {}}, size::small, {}};
+        ASSERT_EQUAL(R"({{1, 2.5, "origin", [1, 2]}, {-1, 0, "a\"b", []}, small, hello, 42})"s, pretty::print(data));
+        ASSERT_EQUAL("[{}, {}]"s, pretty::print(std::vector<empty>(2)));
+        check_format_to(std::map<int, point>{{1, {}}, {2, {3, 4, "", {5}}}});
+        check_visit(data);
+        ASSERT_EQUAL(R"([1,2.5,"origin",[1,2]])"s, pretty::to_json(point{}));
+
+        const auto points = pretty::parse<std::vector<point>>(R"([{1, 2.5, "origin", [1, 2]}, {3, 4, "", []}])");
+        ASSERT_EQUAL(R"([{1, 2.5, "origin", [1, 2]}, {3, 4, "", []}])"s, pretty::print(points));
+    }
+
+    enum plain_level { plain_low, plain_high };
+    enum named_level { named_low, named_high };
+
+    std::ostream& operator<<(std::ostream& out, named_level val) { return out << (val == named_low ? "low" : "high"); }
+
+    constexpr plain_level static_plain = plain_high;
+
+    constexpr std::array<int, 4> static_table = {1, -20, 300, std::numeric_limits<int>::min()};
+    constexpr std::pair<std::string_view, bool> static_pairs[] = {{"a\"b\n\x01", true}, {"\xd0\xb9\xff", false}};
+    constexpr auto static_tuple = std::make_tuple('c', level::high, std::array<unsigned long long, 1>{~0ull}, "str");
+    constexpr point_2d static_point = {{1, 2}, -3};
+    constexpr auto static_escaped = std::make_tuple("q\"b\\\b\f\n\r\t\x01\xff\xd0\xb6");
+
+    void test_static_print() {
+        constexpr const auto& table = pretty::static_print<static_table>();
+        static_assert(table.size() == 26, "test failed");
+        static_assert(table.view() == "[1, -20, 300, -2147483648]", "test failed");
+        ASSERT_EQUAL(pretty::print(static_table), std::string(table));
+        ASSERT_EQUAL(pretty::print(static_pairs), std::string(pretty::static_print<static_pairs>()));
+        ASSERT_EQUAL(pretty::print(static_tuple), std::string(pretty::static_print<static_tuple>()));
+        ASSERT_EQUAL(pretty::print(static_point), std::string(pretty::static_print<static_point>()));
+        ASSERT_EQUAL(pretty::print(static_escaped), std::string(pretty::static_print<static_escaped>()));
+        ASSERT_EQUAL(R"((c, 1, [18446744073709551615], "str"))"s, std::string(pretty::static_print<static_tuple>().c_str()));
+        std::stringstream ss;
+        ss << pretty::static_print<static_point>();
+        ASSERT_EQUAL("{[1, 2], -3}"s, ss.str());
+
+        // unscoped enums: their promotion to int is not an operator<< of their own, one is rejected
+        ASSERT_EQUAL(pretty::print(static_plain), std::string(pretty::static_print<static_plain>()));
+        static_assert(!pretty::detail::has_own_ostream_operator<plain_level>::value, "test failed");
+        static_assert(pretty::detail::has_own_ostream_operator<named_level>::value, "test failed");
+        static_assert(pretty::detail::has_own_ostream_operator<size>::value, "test failed");
+        ASSERT_EQUAL("high"s, pretty::print(named_high));
+    }
+
+    void test_diff() {
+        using state = std::map<std::string, std::vector<int>>;
+        const state a = {{"alice", {1, 2, 3}}, {"bob", {4}}, {"carol", {}}};
+        state b = a;
+        ASSERT_EQUAL(""s, pretty::diff(a, b));
+        b["alice"][1] = 20;
+        b["alice"].push_back(4);
+        b.erase("bob");
+        b["dave"] = {5};
+        ASSERT_EQUAL(R"(["alice"][1]: 2 -> 20
+["alice"][3]: + 4
+["bob"]: - [4]
+["dave"]: + [5]
+)"s,
+                     pretty::diff(a, b));
+        std::stringstream ss;
+        pretty::diff(ss, b, a);
+        ASSERT_EQUAL(R"(["alice"][1]: 20 -> 2
+["alice"][3]: - 4
+["bob"]: + [4]
+["dave"]: - [5]
+)"s,
+                     ss.str());
+
+        using row = std::tuple<int, std::optional<std::string>, std::variant<int, std::string>>;
+        ASSERT_EQUAL(".1: null -> \"x\"\n.2: 1 -> \"1\"\n"s, pretty::diff(row{1, {}, 1}, row{1, "x", "1"}));
+        ASSERT_EQUAL(".2: 1 -> 2\n"s, pretty::diff(row{1, {}, 1}, row{1, {}, 2}));
+        ASSERT_EQUAL("1 -> 2\n"s, pretty::diff(1, 2));
+        ASSERT_EQUAL(".1.0: 1 -> 3\n"s, pretty::diff(line{}, line{{}, {3}, {}, {}}));
+
+        const std::unordered_map<int, std::set<int>> c = {{1, {1, 2}}, {2, {3}}};
+        ASSERT_EQUAL("[1]: - 1\n[1]: + 5\n"s, pretty::diff(c, {{1, {2, 5}}, {2, {3}}}));
+        ASSERT_EQUAL("[2]: - [3]\n"s, pretty::diff(c, {{1, {1, 2}}}));
+        ASSERT_EQUAL("[0]: hello, 42 -> hello, 43\n"s,
+                     pretty::diff(std::vector<user_data>(1), std::vector<user_data>{{43, "hello"}}));
+
+        // character pointers and arrays are compared as text, not by address
+        std::string first = "same", second = "same";
+        const char* first_ptr = first.c_str();
+        ASSERT_EQUAL(""s, pretty::diff(first_ptr, second.c_str()));
+        ASSERT_EQUAL(".1: \"same\" -> \"other\"\n"s,
+                     pretty::diff(std::make_pair(1, first_ptr), std::make_pair(1, static_cast<const char*>("other"))));
+        char name_a[8] = "same", name_b[8] = "same";
+        ASSERT_EQUAL(""s, pretty::diff(name_a, name_b));
+        name_b[0] = 'g';
+        ASSERT_EQUAL("\"same\" -> \"game\"\n"s, pretty::diff(name_a, name_b));
+        std::u16string wide_a = u"same", wide_b = u"same";
+        const char16_t* wide_ptr = wide_a.c_str();
+        ASSERT_EQUAL(""s, pretty::diff(wide_ptr, wide_b.c_str()));
+    }
+
+    void test_cached_printer() {
+        std::map<std::string, std::vector<int>> registry = {{"a", {1, 2}}, {"b", {3}}, {"c", {}}};
+        pretty::cached_printer cache;
+        ASSERT_EQUAL(pretty::print(registry), cache.print(registry));
+        ASSERT_EQUAL(std::size_t{0}, cache.hits());
+        ASSERT_EQUAL(std::size_t{3}, cache.misses());
+        ASSERT_EQUAL(pretty::print(registry), cache.print(registry));
+        ASSERT_EQUAL(std::size_t{3}, cache.hits());
+
+        registry["b"].push_back(4);
+        std::stringstream ss;
+        cache.print(ss, registry);
+        ASSERT_EQUAL(pretty::print(registry), ss.str());
+        ASSERT_EQUAL(std::size_t{5}, cache.hits());
+        ASSERT_EQUAL(std::size_t{4}, cache.misses());
+
+        // a whole value is reused while its version is unchanged, even if the data is not
+        ASSERT_EQUAL(pretty::print(registry), cache.print(registry, 1));
+        registry["a"].clear();
+        ASSERT_EQUAL(R"({"a": [1, 2], "b": [3, 4], "c": []})"s, cache.print(registry, 1));
+        ASSERT_EQUAL(pretty::print(registry), cache.print(registry, 2));
+
+        // 1: "0123456789" and 2: "x" fill the cache, 3: "y" evicts the least recently used one
+        pretty::cached_printer small(21);
+        const std::vector<std::pair<int, std::string>> rows = {{1, "0123456789"}, {2, "x"}};
+        const std::vector<std::pair<int, std::string>> other = {{3, "y"}};
+        ASSERT_EQUAL(pretty::print(rows), small.print(rows));
+        ASSERT_EQUAL(pretty::print(rows), small.print(rows));
+        ASSERT_EQUAL(std::size_t{2}, small.hits());
+        ASSERT_EQUAL(std::size_t{21}, small.size());
+        ASSERT_EQUAL(pretty::print(other), small.print(other));
+        ASSERT_EQUAL(std::size_t{1}, small.evictions());
+        ASSERT_EQUAL(std::size_t{12}, small.size());
+        ASSERT_EQUAL(pretty::print(1.5), small.print(1.5, 7));
+        small.clear();
+        ASSERT_EQUAL(std::size_t{0}, small.size());
+
+        // the cached text is in the default format, formatted streams are printed without it
+        const std::vector<std::vector<int>> numbers = {{255}};
+        ASSERT_EQUAL("[[255]]"s, cache.print(numbers));
+        ss = std::stringstream();
+        ss << std::hex;
+        cache.print(ss, numbers);
+        cache.print(ss, numbers, 3);
+        ASSERT_EQUAL("[[ff]][[ff]]"s, ss.str());
+        ss = std::stringstream();
+        cache.print(ss, numbers);
+        ASSERT_EQUAL("[[255]]"s, ss.str());
+    }
+
+    void test_sorted_unordered() {
+        std::unordered_map<std::string, std::unordered_set<int>> data;
+        for (int i = 99; i >= 0; --i) {
+            data["k" + std::to_string(i % 10)].insert(i);
+        }
+        std::map<std::string, std::set<int>> ordered;
+        for (const auto& [key, values] : data) {
+            ordered[key].insert(values.begin(), values.end());
+        }
+        ASSERT_EQUAL(pretty::print(ordered), pretty::print(data, pretty::sorted_unordered{}));
+
+        std::stringstream ss;
+        pretty::print(ss, std::make_tuple(data, std::vector<int>{2, 1}), pretty::sorted_unordered{});
+        ASSERT_EQUAL("(" + pretty::print(ordered) + ", [2, 1])", ss.str());
+
+        // equal keys keep their iteration order
+        std::unordered_multimap<int, std::string> multi;
+        for (int i = 0; i < 200; ++i) {
+            multi.emplace(i % 3, std::to_string(i));
+        }
+        std::string expected = "[";
+        for (int key = 0; key < 3; ++key) {
+            const auto [first, last] = multi.equal_range(key);
+            for (auto it = first; it != last; ++it) {
+                expected += (expected.size() == 1 ? "" : ", ") + std::to_string(key) + ": \"" + it->second + '"';
+            }
+        }
+        ASSERT_EQUAL(expected + "]", pretty::print(multi, pretty::sorted_unordered{}));
+        ASSERT_EQUAL("[]"s, pretty::print(std::unordered_set<int>{}, pretty::sorted_unordered{}));
+    }
+
+    struct graph_node {
+        int value;
+        std::vector<std::shared_ptr<graph_node>> next;
+    };
+
+    struct holder {
+        int value;
+    };
+
+    void test_deref_pointers() {
+        // shared subobjects print once, cycles end in a reference
+        const auto a = std::make_shared<graph_node>(graph_node{1, {}});
+        const auto b = std::make_shared<graph_node>(graph_node{2, {a}});
+        a->next = {b, b, nullptr};
+        ASSERT_EQUAL("#1 {1, [#2 {2, [<ref #1>]}, <ref #2>, null]}"s, pretty::print(a, pretty::deref_pointers{}));
+        std::stringstream ss;
+        pretty::print(ss, std::weak_ptr<graph_node>(b), pretty::deref_pointers{});
+        ASSERT_EQUAL("#1 {2, [#2 {1, [<ref #1>, <ref #1>, null]}]}"s, ss.str());
+        b->next.clear();
+
+        // character pointers stay strings, a struct and its first member are different objects
+        holder h{7};
+        const auto values = std::make_tuple("text", &h, &h.value, static_cast<const int*>(&h.value), std::weak_ptr<int>(),
+                                            std::make_unique<std::string>("owned"));
+        ASSERT_EQUAL(R"(("text", #1 {7}, #2 7, <ref #2>, null, #3 "owned"))"s,
+                     pretty::print(values, pretty::deref_pointers{}));
+        // other modes keep printing addresses
+        ASSERT_EQUAL(std::string::npos, pretty::print(std::make_tuple(&h.value)).find('#'));
+
+        // a diamond chain has 2^n paths but n objects, the set grows past its inline slots
+        std::vector<std::shared_ptr<graph_node>> chain = {std::make_shared<graph_node>(graph_node{0, {}})};
+        for (int i = 1; i < 100; ++i) {
+            chain.push_back(std::make_shared<graph_node>(graph_node{i, {chain.back(), chain.back()}}));
+        }
+        const std::string text = pretty::print(chain.back(), pretty::deref_pointers{});
+        const std::string first = "#1 {99, [#2 {98, [#3 {97, ";
+        const std::string last = "#100 {0, []}, <ref #100>]}, <ref #99>]}";
+        ASSERT_EQUAL(first, text.substr(0, first.size()));
+        ASSERT_EQUAL(last, text.substr(text.find("#100 "), last.size()));
+        ASSERT_EQUAL(std::size_t{99}, static_cast<std::size_t>(std::count(text.begin(), text.end(), '<')));
+    }
+
+    /** a stream with formatting flags, precision and an iword set */
+    void format_stream(std::ostream& out) {
+        out << std::hex << std::boolalpha << std::setprecision(3);
+        out.iword(length_unit()) = 1;
+    }
+
+    /** the print options keep the formatting state of the stream: values print as with print(out, data) */
+    template <class T, class Options>
+    std::string print_formatted(const T& data, Options options) {
+        std::stringstream ss;
+        format_stream(ss);
+        pretty::print(ss, data, options);
+        return ss.str();
+    }
+
+    void test_options_format() {
+        const auto data = std::make_tuple(std::map<int, std::vector<double>>{{255, {0.5, 1.0 / 3}}, {16, {}}}, true,
+                                          std::vector<length>{{1}}, "str");
+        std::stringstream ss;
+        format_stream(ss);
+        pretty::print(ss, data);
+        const std::string expected = ss.str();
+        ASSERT_EQUAL(R"(({10: [], ff: [0.5, 0.333]}, true, [1mm], "str"))"s, expected);
+
+        ASSERT_EQUAL(expected, print_formatted(data, pretty::limits{}));
+        pretty::limits bytes;
+        bytes.max_bytes = 12;
+        ASSERT_EQUAL(expected.substr(0, 12) + "...", print_formatted(data, bytes));
+        pretty::indent layout;
+        layout.inline_width = expected.size();
+        ASSERT_EQUAL(expected, print_formatted(data, layout));
+        layout.inline_width = expected.size() - 1;
+        ASSERT_EQUAL(std::string::npos, print_formatted(data, layout).find("255"));
+        ASSERT_EQUAL(expected, print_formatted(data, pretty::sorted_unordered{}));
+        ASSERT_EQUAL("(#1 ff, true)"s,
+                     print_formatted(std::make_tuple(std::make_shared<int>(255), true), pretty::deref_pointers{}));
+
+        // the stream is left in its state
+        ASSERT_EQUAL(true, (ss.flags() & std::ios_base::hex) != 0);
+    }
+
+    /** the text of f, written through buffers of size bytes */
+    template <class T>
+    std::string drain(pretty::chunked_formatter<T> f, std::size_t size) {
+        std::vector<char> buf(size);
+        std::string result;
+        while (!f.done()) {
+            const std::string_view chunk = f.next(buf.data(), buf.size());
+            ASSERT_EQUAL(true, chunk.size() == size || f.done());
+            result += chunk;
+        }
+        ASSERT_EQUAL(true, f.next(buf.data(), buf.size()).empty());
+        return result;
+    }
+
+    void test_chunked_formatter() {
+        std::map<std::string, std::vector<std::tuple<int, std::optional<std::string>, std::variant<int, size>>>> data;
+        data["first \"key\""] = {{1, "one", 1}, {2, std::nullopt, size::medium}};
+        data[""] = {};
+        // slices of long strings end between UTF-8 sequences, invalid bytes are escaped as a whole
+        std::string text;
+        for (int i = 0; i < 300; ++i) {
+            text += i % 7 == 0 ? "\n\xff" : i % 2 ? "ж" : "\xe2\x82\xac";
+        }
+        data[text] = {{3, text, 3}};
+        const auto lines = std::make_pair(line{}, std::vector<user_data>(3));
+        // short number ranges are written at once when they surely fit, long ones element by element
+        const std::vector<std::vector<double>> numbers = {std::vector<double>(3, 1.5),
+                                                           std::vector<double>(200, -2.25e-300)};
+
+        // wide strings are resumed from the slice they stopped in, surrogate pairs stay in one slice
+        std::u16string wide;
+        for (int i = 0; i < 600; ++i) {
+            wide += i % 5 == 0 ? u"\"\U0001F600" : i % 3 ? u"ж" : u"\x01a";
+        }
+        static_assert(pretty::detail::cursor_kind_of<std::u16string>() == pretty::detail::cursor_kind::wide_string);
+        const auto wides = std::make_tuple(wide, std::wstring(700, L'w'), U"\U0001F600 \\ end");
+
+        for (const std::size_t size : {1, 2, 3, 5, 64, 4096}) {
+            ASSERT_EQUAL(pretty::print(data), drain(pretty::chunked_formatter(data), size));
+            ASSERT_EQUAL(pretty::print(lines), drain(pretty::chunked_formatter(lines), size));
+            ASSERT_EQUAL(pretty::print(numbers), drain(pretty::chunked_formatter(numbers), size));
+            ASSERT_EQUAL(pretty::print(wides), drain(pretty::chunked_formatter(wides), size));
+        }
+
+        const std::vector<int> empty;
+        pretty::chunked_formatter f(empty);
+        char buf[8];
+        ASSERT_EQUAL(true, f.next(buf, 0).empty() && !f.done());
+        ASSERT_EQUAL("[]"s, std::string(f.next(buf)));
+        ASSERT_EQUAL(true, f.done());
+    }
+
+    template <class T>
+    std::size_t parse_error_position(std::string_view text) {
+        try {
+            pretty::parse<T>(text);
+        } catch (const pretty::parse_error& e) {
+            return e.position();
+        }
+        return std::string_view::npos;
+    }
+
+    template <class T>
+    void check_parse(const T& data) {
+        const std::string text = pretty::print(data);
+        ASSERT_EQUAL(text, pretty::print(pretty::parse<T>(text)));
+        ASSERT_EQUAL(text, pretty::print(pretty::parse<T>(pretty::print(data, pretty::indent{}))));
+    }
+
+    void test_parse() {
+        check_parse(std::map<std::string, std::vector<int>>{{"a\"b", {1, -2, 3}}, {"c\\\n\t\x01", {}}});
+        check_parse(std::make_tuple("1"s, 2, 3u, 4.5, 'c', true, std::optional<int>{}, std::optional<long>{-7}));
+        check_parse(std::vector<std::variant<int, std::string, std::vector<int>>>{1, "two", std::vector<int>{3}});
+        check_parse(std::vector<std::pair<int, std::set<char>>>{{1, {'a', 'b'}}, {2, {}}});
+        check_parse(std::vector<char>{'a', '\t', ',', ']', '\r'});
+        check_parse(std::make_tuple('\t', std::map<char, char>{{'\t', ','}, {':', ':'}}, std::array<char, 2>{',', 'x'}));
+        // a space is a character, not whitespace around it
+        using spaced = std::tuple<char, std::vector<char>, std::map<char, char>>;
+        const spaced spaces = {' ', {' ', 'a', ' '}, {{' ', ' '}}};
+        ASSERT_EQUAL(pretty::print(spaces), pretty::print(pretty::parse<spaced>(pretty::print(spaces))));
+        ASSERT_EQUAL(std::size_t{1}, pretty::parse<std::vector<char>>("[ ]").size());
+        check_parse(std::array<std::array<double, 2>, 2>{{{1.5, -0.25}, {1e20, 0}}});
+        check_parse(std::unordered_map<int, std::list<std::string>>{{1, {"x", ""}}});
+        enum class color { red, green, blue };
+        check_parse(std::vector<color>{color::blue, color::red});
+
+        ASSERT_EQUAL("[1, 2, 3]"s, pretty::print(pretty::parse<std::vector<int>>(" [ 1,2 ,\n3 ] ")));
+        int data[2][2] = {};
+        std::stringstream ss;
+        pretty::print(ss, pretty::parse<std::array<std::array<int, 2>, 2>>("[[1, 2], [3, 4]]"));
+        pretty::detail::parser("[[1, 2], [3, 4]]").read(data);
+        ASSERT_EQUAL(ss.str(), pretty::print(data));
+
+        ASSERT_EQUAL(std::size_t{5}, parse_error_position<std::vector<int>>("[1, 2"));
+        ASSERT_EQUAL(std::size_t{2}, parse_error_position<std::vector<int>>("[1; 2]"));
+        ASSERT_EQUAL(std::size_t{4}, parse_error_position<std::vector<int>>("[1, x]"));
+        ASSERT_EQUAL(std::size_t{7}, parse_error_position<std::vector<int>>("[1, 2] 3"));
+        ASSERT_EQUAL(std::size_t{4}, parse_error_position<std::string>("\"abc"));
+        ASSERT_EQUAL(std::size_t{3}, parse_error_position<std::string>("\"\\x4\""));
+        ASSERT_EQUAL(std::size_t{0}, parse_error_position<std::optional<int>>("nul"));
+    }
 }  // namespace pretty_test
 
 
@@ -199,4 +1336,27 @@ void run_test() {
     test_filesystem_path();
 #endif
     test_enum();
+    test_format_to();
+    test_escape();
+    test_utf();
+    test_numbers();
+    test_limits();
+    test_sink();
+    test_parallel();
+    test_async();
+    test_lazy();
+    test_allocations();
+    test_print_ti();
+    test_instrumentation();
+    test_indent();
+    test_visit();
+    test_aggregate();
+    test_static_print();
+    test_diff();
+    test_cached_printer();
+    test_sorted_unordered();
+    test_chunked_formatter();
+    test_deref_pointers();
+    test_options_format();
+    test_parse();
 }
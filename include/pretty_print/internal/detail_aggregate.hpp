@@ -0,0 +1,147 @@
+#pragma once
+#include <cstddef>      // std::size_t
+#include <tuple>        // std::tie
+#include <type_traits>  // std::is_aggregate_v, std::is_base_of_v, std::void_t
+#include <utility>      // std::index_sequence
+
+namespace pretty::detail {
+
+    /** the most fields an aggregate may have to be printed without operator<< */
+    inline constexpr std::size_t max_aggregate_fields = 16;
+
+    /** converts to any field type, so T{any_field...} compiles only up to the number of fields of T */
+    template <class T>
+    struct any_field {
+        template <class U, typename = std::enable_if_t<!std::is_same_v<std::remove_cv_t<U>, T>>>
+        operator U() const;
+    };
+
+    template <class T, class Is, typename = void>
+    struct is_brace_constructible : std::false_type {};
+    template <class T, std::size_t... Is>
+    struct is_brace_constructible<T, std::index_sequence<Is...>,
+                                  std::void_t<decltype(T{(void(Is), any_field<T>{})...})>> : std::true_type {};
+
+    /** number of fields of aggregate T: the largest N for which T{any_field x N} compiles */
+    template <class T, std::size_t N = 0>
+    constexpr std::size_t field_count() {
+        if constexpr (N < max_aggregate_fields && is_brace_constructible<T, std::make_index_sequence<N + 1>>::value) {
+            return field_count<T, N + 1>();
+        } else {
+            return N;
+        }
+    }
+
+    /** converts only to the base classes of T, so T{any_base} compiles only if T has one */
+    template <class T>
+    struct any_base {
+        template <class U,
+                  typename = std::enable_if_t<std::is_base_of_v<U, T> && !std::is_same_v<std::remove_cv_t<U>, T>>>
+        operator U() const;
+    };
+
+    template <class T, typename = void>
+    struct has_base : std::false_type {};
+    template <class T>
+    struct has_base<T, std::void_t<decltype(T{any_base<T>{}})>> : std::true_type {};
+
+    template <class T, class Before, class After, typename = void>
+    struct is_brace_constructible_at : std::false_type {};
+    template <class T, std::size_t... Is, std::size_t... Js>
+    struct is_brace_constructible_at<
+        T, std::index_sequence<Is...>, std::index_sequence<Js...>,
+        std::void_t<decltype(T{(void(Is), any_field<T>{})..., {}, (void(Js), any_field<T>{})...})>>
+        : std::true_type {};
+
+    /** every one of the N initializers of T{any_field x N} is a field of its own: a {} in its place still
+     * compiles, while one in place of the first element of a C array field takes the whole array and leaves
+     * an initializer too many; structured bindings then decompose T into exactly N fields */
+    template <class T, std::size_t N, std::size_t... Is>
+    constexpr bool has_fields(std::index_sequence<Is...>) {
+        return (
+            is_brace_constructible_at<T, std::make_index_sequence<Is>, std::make_index_sequence<N - Is - 1>>::value &&
+            ...);
+    }
+
+    template <class T>
+    constexpr bool is_plain_aggregate() {
+        if constexpr (std::is_class_v<T> && std::is_aggregate_v<T> && !std::is_union_v<T>) {
+            if constexpr (is_brace_constructible<T, std::make_index_sequence<max_aggregate_fields + 1>>::value ||
+                          has_base<T>::value) {
+                return false;
+            } else {
+                return has_fields<T, field_count<T>()>(std::make_index_sequence<field_count<T>()>{});
+            }
+        } else {
+            return false;
+        }
+    }
+
+    /** class aggregates, printed field by field when they have no operator<<
+     * aggregates with more than max_aggregate_fields fields, base classes, C array fields or fields that
+     * can not be initialized from {} are not, see has_fields */
+    template <class T>
+    inline constexpr bool is_plain_aggregate_v = is_plain_aggregate<T>();
+
+    /** tuple of references to the fields of aggregate data, decomposed with structured bindings */
+    template <std::size_t N, class T>
+    constexpr auto tie_fields(T& data) {
+        if constexpr (N == 0) {
+            return std::tuple<>();
+        } else if constexpr (N == 1) {
+            auto& [a] = data;
+            return std::tie(a);
+        } else if constexpr (N == 2) {
+            auto& [a, b] = data;
+            return std::tie(a, b);
+        } else if constexpr (N == 3) {
+            auto& [a, b, c] = data;
+            return std::tie(a, b, c);
+        } else if constexpr (N == 4) {
+            auto& [a, b, c, d] = data;
+            return std::tie(a, b, c, d);
+        } else if constexpr (N == 5) {
+            auto& [a, b, c, d, e] = data;
+            return std::tie(a, b, c, d, e);
+        } else if constexpr (N == 6) {
+            auto& [a, b, c, d, e, f] = data;
+            return std::tie(a, b, c, d, e, f);
+        } else if constexpr (N == 7) {
+            auto& [a, b, c, d, e, f, g] = data;
+            return std::tie(a, b, c, d, e, f, g);
+        } else if constexpr (N == 8) {
+            auto& [a, b, c, d, e, f, g, h] = data;
+            return std::tie(a, b, c, d, e, f, g, h);
+        } else if constexpr (N == 9) {
+            auto& [a, b, c, d, e, f, g, h, i] = data;
+            return std::tie(a, b, c, d, e, f, g, h, i);
+        } else if constexpr (N == 10) {
+            auto& [a, b, c, d, e, f, g, h, i, j] = data;
+            return std::tie(a, b, c, d, e, f, g, h, i, j);
+        } else if constexpr (N == 11) {
+            auto& [a, b, c, d, e, f, g, h, i, j, k] = data;
+            return std::tie(a, b, c, d, e, f, g, h, i, j, k);
+        } else if constexpr (N == 12) {
+            auto& [a, b, c, d, e, f, g, h, i, j, k, l] = data;
+            return std::tie(a, b, c, d, e, f, g, h, i, j, k, l);
+        } else if constexpr (N == 13) {
+            auto& [a, b, c, d, e, f, g, h, i, j, k, l, m] = data;
+            return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m);
+        } else if constexpr (N == 14) {
+            auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, n] = data;
+            return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, n);
+        } else if constexpr (N == 15) {
+            auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, n, o] = data;
+            return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o);
+        } else if constexpr (N == 16) {
+            auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p] = data;
+            return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p);
+        }
+    }
+
+    template <class T>
+    constexpr auto tie_fields(T& data) {
+        return tie_fields<field_count<std::remove_const_t<T>>()>(data);
+    }
+
+}  // namespace pretty::detail
@@ -0,0 +1,401 @@
+#pragma once
+#include <atomic>              // std::atomic
+#include <chrono>              // std::chrono::milliseconds
+#include <condition_variable>  // std::condition_variable
+#include <cstddef>             // std::size_t, std::ptrdiff_t, std::max_align_t
+#include <memory>              // std::unique_ptr
+#include <mutex>               // std::mutex, std::unique_lock
+#include <new>                 // placement new
+#include <string>              // std::basic_string
+#include <string_view>         // std::basic_string_view
+#include <thread>              // std::thread, std::this_thread::yield
+#include <tuple>               // std::tuple, std::apply
+#include <type_traits>         // std::decay_t, std::remove_const_t
+#include <utility>             // std::forward
+#include <vector>              // std::vector
+
+#include "detail_pretty_print.hpp"
+
+namespace pretty {
+
+    /** what async_printer does with a record when its queue is full */
+    enum class overflow_policy {
+        block,  ///< wait for the background thread to free a slot
+        drop,   ///< discard the record and count it in dropped()
+        grow    ///< put the record into a mutex-guarded overflow list
+    };
+
+}  // namespace pretty
+
+namespace pretty::detail {
+
+    template <typename T>
+    struct async_stored {
+        using type = T;
+    };
+    template <typename CharT, typename Traits>
+    struct async_stored<std::basic_string_view<CharT, Traits>> {
+        using type = std::basic_string<CharT, Traits>;
+    };
+    template <typename CharT>
+    struct async_stored<CharT*> {
+        using char_type = std::remove_const_t<CharT>;
+        using type = std::conditional_t<std::is_same_v<char_type, char> || is_wide_char_v<char_type>,
+                                        std::basic_string<char_type>, CharT*>;
+    };
+
+    /** arguments are copied into the queue, string views and character pointers as strings so that they may
+     * not outlive the call; other pointers are stored as they are and print as addresses */
+    template <typename T>
+    using async_stored_t = typename async_stored<std::decay_t<T>>::type;
+
+    template <bool Line, class Stream, class... Args>
+    void async_write(Stream& out, const Args&... args) {
+        (((void)ostream::ostream_impl(out, args), append(out, ' ')), ...);
+        if constexpr (Line) {
+            append(out, '\n');
+        }
+    }
+
+    template <typename Stream, typename = void>
+    struct has_flush : std::false_type {};
+    template <typename Stream>
+    struct has_flush<Stream, std::void_t<decltype(std::declval<Stream&>().flush())>> : std::true_type {};
+
+    /** formats the record in storage to out unless out is nullptr, then destroys it */
+    template <class Stream>
+    using async_invoke_fn = void (*)(void* storage, Stream* out);
+
+    /** a record in the queue: its arguments, inline when they fit, and the function that prints them */
+    template <class Stream>
+    struct async_slot {
+        static constexpr std::size_t inline_size = 96;
+
+        std::atomic<std::size_t> sequence{0};
+        async_invoke_fn<Stream> invoke = nullptr;
+        alignas(std::max_align_t) unsigned char storage[inline_size];
+    };
+
+    template <class Stream, bool Line, class Tuple, bool Inline>
+    void async_invoke(void* storage, Stream* out) {
+        Tuple* args = nullptr;
+        if constexpr (Inline) {
+            args = static_cast<Tuple*>(storage);
+        } else {
+            args = *static_cast<Tuple**>(storage);
+        }
+        if (out) {
+            try {
+                std::apply([out](const auto&... arg) { async_write<Line>(*out, arg...); }, *args);
+            } catch (...) {
+                // the record is dropped, the printer keeps running
+            }
+        }
+        if constexpr (Inline) {
+            args->~Tuple();
+        } else {
+            delete args;
+        }
+    }
+
+    /** stands in for a record whose arguments threw while being copied into a claimed slot */
+    template <class Stream>
+    void async_skip(void*, Stream*) noexcept {}
+
+    /** construct the record for args in storage and return the function that prints it */
+    template <class Stream, bool Line, class... Args>
+    async_invoke_fn<Stream> async_emplace(void* storage, Args&&... args) {
+        using tuple_type = std::tuple<async_stored_t<Args>...>;
+        if constexpr (sizeof(tuple_type) <= async_slot<Stream>::inline_size &&
+                      alignof(tuple_type) <= alignof(std::max_align_t)) {
+            new (storage) tuple_type(std::forward<Args>(args)...);
+            return &async_invoke<Stream, Line, tuple_type, true>;
+        } else {
+            *static_cast<tuple_type**>(storage) = new tuple_type(std::forward<Args>(args)...);
+            return &async_invoke<Stream, Line, tuple_type, false>;
+        }
+    }
+
+}  // namespace pretty::detail
+
+namespace pretty {
+
+    /** print_line and print_args with the formatting and the output on a background thread
+     * callers copy or move their arguments into a bounded lock-free multi-producer queue,
+     * the background thread is the only one using out until shutdown() */
+    template <class Stream>
+    class async_printer {
+    public:
+        /** @param out Stream or sink, used only by the background thread
+         * @param capacity queue slots, rounded up to a power of two
+         * @param policy what to do with records when the queue is full */
+        explicit async_printer(Stream& out, std::size_t capacity = 4096,
+                               overflow_policy policy = overflow_policy::block)
+            : out_(out), mask_(round_up(capacity) - 1), slots_(new slot_type[mask_ + 1]), policy_(policy) {
+            for (std::size_t i = 0; i <= mask_; ++i) {
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            thread_ = std::thread([this] { run(); });
+        }
+        ~async_printer() { shutdown(); }
+
+        async_printer(const async_printer&) = delete;
+        async_printer& operator=(const async_printer&) = delete;
+
+        /** queue pretty::print_line(out, args...)
+         * @return false if the record was dropped */
+        template <class... Args>
+        bool print_line(Args&&... args) {
+            return push<true>(std::forward<Args>(args)...);
+        }
+
+        /** queue pretty::print_args(out, args...)
+         * @return false if the record was dropped */
+        template <class... Args>
+        bool print_args(Args&&... args) {
+            return push<false>(std::forward<Args>(args)...);
+        }
+
+        /** wait until everything queued before the call is printed and out is flushed */
+        void flush() {
+            const std::size_t target = pushed_.load();
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.notify_one();
+            done_cv_.wait(lock, [&] { return done_ >= target || stopped_; });
+        }
+
+        /** print everything queued and stop the background thread, later records are dropped */
+        void shutdown() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stopping_.exchange(true)) {
+                    return;
+                }
+                wake_.notify_one();
+            }
+            thread_.join();
+            // producers that passed the stopping_ check before it was set may still be filling a slot,
+            // the records they put in after the last drain of the thread are printed here
+            while (producers_.load() != 0) {
+                std::this_thread::yield();
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_ += drain();
+            if constexpr (detail::has_flush<Stream>::value) {
+                out_.flush();
+            }
+        }
+
+        /** records discarded because the queue was full or the printer was shut down */
+        std::size_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        using slot_type = detail::async_slot<Stream>;
+
+        struct overflow_record {
+            detail::async_invoke_fn<Stream> invoke;
+            std::unique_ptr<unsigned char[]> storage;
+        };
+
+        static std::size_t round_up(std::size_t n) {
+            std::size_t result = 2;
+            while (result < n) {
+                result *= 2;
+            }
+            return result;
+        }
+
+        /** counts a producer in push, shutdown waits for producers_ after stopping_ is set */
+        class producer_scope {
+        public:
+            explicit producer_scope(std::atomic<std::size_t>& producers) noexcept : producers_(producers) {
+                producers_.fetch_add(1);
+            }
+            ~producer_scope() { producers_.fetch_sub(1); }
+
+            producer_scope(const producer_scope&) = delete;
+            producer_scope& operator=(const producer_scope&) = delete;
+
+        private:
+            std::atomic<std::size_t>& producers_;
+        };
+
+        template <bool Line, class... Args>
+        bool push(Args&&... args) {
+            // sequentially consistent with the store of stopping_ in shutdown: either this push sees it set,
+            // or shutdown sees the producer and drains after it
+            const producer_scope producer(producers_);
+            if (stopping_.load()) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            for (;;) {
+                if (!overflowing_.load(std::memory_order_acquire)) {
+                    if (try_push<Line>(std::forward<Args>(args)...)) {
+                        break;
+                    }
+                    if (policy_ == overflow_policy::drop) {
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    }
+                    if (policy_ == overflow_policy::block) {
+                        if (stopping_.load()) {
+                            // the background thread may be gone, nobody would free a slot
+                            dropped_.fetch_add(1, std::memory_order_relaxed);
+                            return false;
+                        }
+                        notify();
+                        std::this_thread::yield();
+                        continue;
+                    }
+                }
+                // grow: once the overflow list is used, records go there until the background thread takes it,
+                // so the records of one thread stay in order
+                overflow_record record{nullptr, std::make_unique<unsigned char[]>(slot_type::inline_size)};
+                record.invoke = detail::async_emplace<Stream, Line>(record.storage.get(), std::forward<Args>(args)...);
+                std::lock_guard<std::mutex> lock(overflow_mutex_);
+                overflow_.push_back(std::move(record));
+                overflowing_.store(true, std::memory_order_release);
+                break;
+            }
+            pushed_.fetch_add(1);
+            notify();
+            return true;
+        }
+
+        /** Vyukov's bounded queue: claim a slot by its sequence number, fill it, publish the next number
+         * args are moved from only if a slot was claimed; if copying them throws, the slot is published empty
+         * and counted as pushed, so that the background thread and flush do not wait for it */
+        template <bool Line, class... Args>
+        bool try_push(Args&&... args) {
+            std::size_t pos = tail_.load(std::memory_order_relaxed);
+            slot_type* slot = nullptr;
+            for (;;) {
+                slot = &slots_[pos & mask_];
+                const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+                if (diff == 0) {
+                    if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = tail_.load(std::memory_order_relaxed);
+                }
+            }
+            try {
+                slot->invoke = detail::async_emplace<Stream, Line>(slot->storage, std::forward<Args>(args)...);
+            } catch (...) {
+                slot->invoke = &detail::async_skip<Stream>;
+                slot->sequence.store(pos + 1, std::memory_order_release);
+                pushed_.fetch_add(1);
+                throw;
+            }
+            slot->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool try_pop() {
+            slot_type& slot = slots_[head_ & mask_];
+            if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) {
+                return false;
+            }
+            slot.invoke(slot.storage, &out_);
+            slot.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+            ++head_;
+            return true;
+        }
+
+        void notify() {
+            if (sleeping_.load()) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                wake_.notify_one();
+            }
+        }
+
+        /** print the records in the queue and the overflow list
+         * @return the number of records printed */
+        std::size_t drain() {
+            std::size_t done = 0;
+            for (;;) {
+                while (try_pop()) {
+                    ++done;
+                }
+                if (!overflowing_.load()) {
+                    return done;
+                }
+                std::vector<overflow_record> overflow;
+                std::size_t tail = 0;
+                {
+                    std::lock_guard<std::mutex> lock(overflow_mutex_);
+                    overflow.swap(overflow_);
+                    tail = tail_.load();
+                    overflowing_.store(false);
+                }
+                // slots claimed before the list was taken hold older records of the same threads
+                while (head_ != tail) {
+                    if (try_pop()) {
+                        ++done;
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+                for (auto& record : overflow) {
+                    record.invoke(record.storage.get(), &out_);
+                    ++done;
+                }
+            }
+        }
+
+        void run() {
+            std::size_t done = 0;
+            for (;;) {
+                const bool stopping = stopping_.load();
+                done += drain();
+
+                if constexpr (detail::has_flush<Stream>::value) {
+                    out_.flush();
+                }
+                std::unique_lock<std::mutex> lock(mutex_);
+                done_ = done;
+                done_cv_.notify_all();
+                if (stopping) {
+                    stopped_ = true;
+                    return;
+                }
+                sleeping_.store(true);
+                if (done == pushed_.load() && !stopping_.load()) {
+                    wake_.wait_for(lock, std::chrono::milliseconds(10));
+                }
+                sleeping_.store(false);
+            }
+        }
+
+        Stream& out_;
+        const std::size_t mask_;
+        std::unique_ptr<slot_type[]> slots_;
+        const overflow_policy policy_;
+
+        alignas(64) std::atomic<std::size_t> tail_{0};
+        alignas(64) std::size_t head_ = 0;
+        std::atomic<std::size_t> pushed_{0};
+        std::atomic<std::size_t> dropped_{0};
+        std::atomic<std::size_t> producers_{0};
+        std::atomic<bool> sleeping_{false};
+        std::atomic<bool> stopping_{false};
+        std::atomic<bool> overflowing_{false};
+
+        std::mutex overflow_mutex_;
+        std::vector<overflow_record> overflow_;
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_cv_;
+        std::size_t done_ = 0;
+        bool stopped_ = false;
+
+        std::thread thread_;
+    };
+
+}  // namespace pretty
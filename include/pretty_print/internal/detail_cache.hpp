@@ -0,0 +1,273 @@
+#pragma once
+#include <cstddef>        // std::size_t
+#include <cstdint>        // std::uint64_t
+#include <cstring>        // std::memcpy
+#include <functional>     // std::hash
+#include <list>           // std::list
+#include <ostream>        // std::ostream
+#include <string>         // std::string
+#include <string_view>    // std::string_view
+#include <type_traits>    // std::enable_if_t, std::is_base_of_v
+#include <unordered_map>  // std::unordered_map
+#include <utility>        // std::move
+
+#include "detail_parallel.hpp"
+#include "detail_visit.hpp"
+
+namespace pretty::detail {
+
+    /** visit backend folding the events into a 64-bit hash, a cheap fingerprint of what print would write */
+    class hash_backend {
+    public:
+        void begin_array(std::size_t size) { mix(1, size); }
+        void end_array() { mix(2); }
+        void begin_map(std::size_t size) { mix(3, size); }
+        void end_map() { mix(4); }
+        void begin_tuple(std::size_t size) { mix(5, size); }
+        void end_tuple() { mix(6); }
+        void begin_struct(std::size_t size) { mix(7, size); }
+        void end_struct() { mix(8); }
+        void begin_pair() { mix(9); }
+        void end_pair() { mix(10); }
+        void element(std::size_t) {}
+        void key() { mix(11); }
+
+        void null() { mix(12); }
+        void boolean(bool value) { mix(13, value); }
+        template <class T>
+        void integer(T value) {
+            mix(14, static_cast<std::uint64_t>(value));
+        }
+        template <class T>
+        void floating(T value) {
+            const double d = static_cast<double>(value);
+            std::uint64_t bits = 0;
+            std::memcpy(&bits, &d, sizeof(bits));
+            mix(15, bits);
+        }
+        void character(char value) { mix(16, static_cast<unsigned char>(value)); }
+        void string(std::string_view value) { mix(17, std::hash<std::string_view>{}(value)); }
+        template <class T>
+        void text(const T& value) {
+            mix(18, std::hash<std::string>{}(to_text(value)));
+        }
+
+        std::uint64_t value() const noexcept { return hash_; }
+
+    private:
+        void mix(std::uint64_t tag, std::uint64_t value = 0) noexcept {
+            hash_ ^= tag + 0x9e3779b97f4a7c15ull + (hash_ << 6) + (hash_ >> 2);
+            hash_ ^= value + 0x9e3779b97f4a7c15ull + (hash_ << 6) + (hash_ >> 2);
+        }
+
+        std::uint64_t hash_ = 0xcbf29ce484222325ull;
+    };
+
+    /** distinct address per type, an RTTI-free type identity */
+    template <class T>
+    const void* type_id() noexcept {
+        static const char id = 0;
+        return &id;
+    }
+
+    template <class T>
+    inline constexpr bool is_cached_element_v = !(std::is_arithmetic_v<T> || std::is_enum_v<T> ||
+                                                  is_std_string<T>::value || is_c_string_v<T> ||
+                                                  std::is_pointer_v<T>);
+
+    template <class Stream>
+    inline constexpr bool is_output_stream_v = std::is_base_of_v<std::ostream, Stream> || is_writer_v<Stream>;
+
+}  // namespace pretty::detail
+
+namespace pretty {
+
+    /** pretty::print that remembers what it wrote, for data printed again and again with few changes
+     * the text of a whole value is reused while its address, type and version are the same;
+     * otherwise the value is printed again, reusing the text of every element of a top-level container
+     * whose address, type and content hash are unchanged
+     * memory is bounded by capacity bytes of text, least recently used entries are evicted first
+     * the text is cached in the default formatting state, streams with any formatting flag changed, e.g. std::hex,
+     * are printed as by pretty::print without the cache
+     * not thread safe; elements are told apart by a 64-bit hash of their content, so an element replaced at the
+     * same address by other content is printed again only probabilistically, a hash collision serves the old text */
+    class cached_printer {
+    public:
+        /** @param capacity bytes of cached text */
+        explicit cached_printer(std::size_t capacity = 1 << 20) : capacity_(capacity) {}
+
+        /** print data, reusing the text of unchanged top-level elements
+         * @param out Stream
+         * @param data data
+         * @return Stream */
+        template <class Stream, class T, typename = std::enable_if_t<detail::is_output_stream_v<Stream>>>
+        Stream& print(Stream& out, const T& data) {
+            if (!detail::has_default_format(out)) {
+                return detail::ostream::ostream_impl(out, data);
+            }
+            scratch_.clear();
+            render(scratch_, data);
+            detail::append(out, std::string_view(scratch_));
+            return out;
+        }
+
+        /** print data, reusing its whole text while version is the one passed the last time
+         * @param out Stream
+         * @param data data, identified by its address
+         * @param version generation counter the caller changes whenever data changes
+         * @return Stream */
+        template <class Stream, class T, typename = std::enable_if_t<detail::is_output_stream_v<Stream>>>
+        Stream& print(Stream& out, const T& data, std::uint64_t version) {
+            if (!detail::has_default_format(out)) {
+                return detail::ostream::ostream_impl(out, data);
+            }
+            detail::append(out, lookup_root(data, version));
+            return out;
+        }
+
+        /** @return std::string, see print(out, data) */
+        template <class T, typename = std::enable_if_t<!detail::is_output_stream_v<T>>>
+        std::string print(const T& data) {
+            std::string result;
+            render(result, data);
+            return result;
+        }
+
+        /** @return std::string, see print(out, data, version) */
+        template <class T, typename = std::enable_if_t<!detail::is_output_stream_v<T>>>
+        std::string print(const T& data, std::uint64_t version) {
+            return std::string(lookup_root(data, version));
+        }
+
+        /** prints served from the cache, whole values and elements */
+        std::size_t hits() const noexcept { return hits_; }
+        /** values and elements that had to be printed */
+        std::size_t misses() const noexcept { return misses_; }
+        /** entries dropped to stay within capacity */
+        std::size_t evictions() const noexcept { return evictions_; }
+        /** bytes of cached text */
+        std::size_t size() const noexcept { return size_; }
+
+        void clear() {
+            index_.clear();
+            entries_.clear();
+            size_ = 0;
+        }
+
+    private:
+        struct key {
+            const void* address;
+            const void* type;
+            std::uint64_t version;
+            bool versioned;
+
+            bool operator==(const key& other) const noexcept {
+                return address == other.address && type == other.type && version == other.version &&
+                       versioned == other.versioned;
+            }
+        };
+
+        struct key_hash {
+            std::size_t operator()(const key& k) const noexcept {
+                std::size_t h = std::hash<const void*>{}(k.address);
+                h ^= std::hash<const void*>{}(k.type) + 0x9e3779b9 + (h << 6) + (h >> 2);
+                h ^= std::hash<std::uint64_t>{}(k.version) + 0x9e3779b9 + (h << 6) + (h >> 2);
+                return h ^ static_cast<std::size_t>(k.versioned);
+            }
+        };
+
+        struct entry {
+            key id;
+            std::string text;
+        };
+
+        /** cached text for id moved to the front, or nullptr */
+        const std::string* find(const key& id) {
+            const auto it = index_.find(id);
+            if (it == index_.end()) {
+                ++misses_;
+                return nullptr;
+            }
+            ++hits_;
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return &it->second->text;
+        }
+
+        void insert(const key& id, std::string_view text) {
+            if (text.size() > capacity_) {
+                return;
+            }
+            while (size_ + text.size() > capacity_) {
+                size_ -= entries_.back().text.size();
+                index_.erase(entries_.back().id);
+                entries_.pop_back();
+                ++evictions_;
+            }
+            entries_.push_front({id, std::string(text)});
+            index_[id] = entries_.begin();
+            size_ += text.size();
+        }
+
+        /** text of data, valid until the next call */
+        template <class T>
+        std::string_view lookup_root(const T& data, std::uint64_t version) {
+            const key id{&data, detail::type_id<T>(), version, true};
+            if (const std::string* text = find(id)) {
+                return *text;
+            }
+            scratch_.clear();
+            render(scratch_, data);
+            insert(id, scratch_);
+            return scratch_;
+        }
+
+        template <class T>
+        void render(std::string& buffer, const T& data) {
+            constexpr bool is_container = detail::is_iterable_v<T> && !detail::is_c_string_v<T> &&
+                                          (!detail::has_ostream_operator_v<std::ostream, T> || std::is_array_v<T>);
+            if constexpr (is_container) {
+                using element_type = std::remove_cv_t<std::remove_reference_t<decltype(*std::begin(data))>>;
+                if constexpr (detail::is_cached_element_v<element_type>) {
+                    buffer += detail::is_map_v<T> ? '{' : '[';
+                    const char* delimiter = "";
+                    for (const auto& el : data) {
+                        buffer += delimiter;
+                        render_element(buffer, el);
+                        delimiter = ", ";
+                    }
+                    buffer += detail::is_map_v<T> ? '}' : ']';
+                    return;
+                }
+            }
+            detail::string_writer<std::string> writer(buffer);
+            detail::ostream::ostream_impl(writer, data);
+        }
+
+        template <class T>
+        void render_element(std::string& buffer, const T& el) {
+            detail::hash_backend fingerprint;
+            detail::traverse(fingerprint, el);
+            const key id{&el, detail::type_id<T>(), fingerprint.value(), false};
+            if (const std::string* text = find(id)) {
+                buffer += *text;
+                return;
+            }
+            const std::size_t begin = buffer.size();
+            {
+                detail::string_writer<std::string> writer(buffer);
+                detail::ostream::ostream_impl(writer, detail::quoted_helper(el), 1);
+            }
+            insert(id, std::string_view(buffer).substr(begin));
+        }
+
+        const std::size_t capacity_;
+        std::list<entry> entries_;
+        std::unordered_map<key, std::list<entry>::iterator, key_hash> index_;
+        std::string scratch_;
+        std::size_t size_ = 0;
+        std::size_t hits_ = 0;
+        std::size_t misses_ = 0;
+        std::size_t evictions_ = 0;
+    };
+
+}  // namespace pretty
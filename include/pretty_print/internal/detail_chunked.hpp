@@ -0,0 +1,409 @@
+#pragma once
+#include <algorithm>    // std::min
+#include <cstddef>      // std::size_t
+#include <cstring>      // std::memcpy
+#include <iterator>     // std::begin, std::end, std::size
+#include <string_view>  // std::string_view
+#include <tuple>        // std::tuple, std::get, std::tuple_size_v
+#include <type_traits>  // std::declval, std::remove_cv_t
+#include <utility>      // std::pair, std::index_sequence
+
+#include "detail_pretty_print.hpp"
+#include "detail_visit.hpp"
+#include "detail_writer.hpp"
+
+#if __has_include(<variant>)
+#include <variant>  // std::variant
+#endif
+#if __has_include(<optional>)
+#include <optional>  // std::optional
+#endif
+
+namespace pretty::detail {
+
+    /** writer into a fixed buffer that skips the bytes of a piece sent by earlier calls and drops those past
+     * the end of the buffer, so that any piece of text can be cut and resumed, see piece */
+    class chunk_writer : public basic_writer<chunk_writer> {
+    public:
+        chunk_writer(char* buf, std::size_t capacity) noexcept : buf_(buf), capacity_(capacity) {}
+
+        void write(const char* s, std::size_t n) noexcept {
+            const std::size_t skipped = std::min(n, skip_);
+            skip_ -= skipped;
+            const std::size_t fits = std::min(n - skipped, capacity_ - size_);
+            if (fits != 0) {
+                std::memcpy(buf_ + size_, s + skipped, fits);
+                size_ += fits;
+            }
+            dropped_ |= fits != n - skipped;
+        }
+        void put(char c) noexcept { write(&c, 1); }
+
+        std::size_t size() const noexcept { return size_; }
+        std::size_t space() const noexcept { return capacity_ - size_; }
+
+        /** write the text fn(*this) writes, without its first offset bytes
+         * @return true once the text is written up to its end, otherwise offset is moved past the bytes
+         * that fit and the text is rendered again on the next call */
+        template <class F>
+        bool render(std::size_t& offset, F&& fn) {
+            skip_ = offset;
+            dropped_ = false;
+            const std::size_t before = size_;
+            fn(*this);
+            if (!dropped_) {
+                offset = 0;
+                return true;
+            }
+            offset += size_ - before;
+            return false;
+        }
+
+        bool piece(std::size_t& offset, std::string_view text) {
+            return render(offset, [text](chunk_writer& out) { out.write(text.data(), text.size()); });
+        }
+
+    private:
+        char* buf_;
+        std::size_t capacity_;
+        std::size_t size_ = 0;
+        std::size_t skip_ = 0;
+        bool dropped_ = false;
+    };
+
+    /** end of the slice of str from pos that is escaped as one piece: at most 256 bytes, never inside
+     * a UTF-8 sequence, so escaping the slices one by one gives the text of write_escaped(str) */
+    inline std::size_t escape_slice_end(std::string_view str, std::size_t pos) noexcept {
+        constexpr std::size_t slice = 256;
+        if (str.size() - pos <= slice) {
+            return str.size();
+        }
+        const std::size_t end = pos + slice;
+        for (std::size_t back = 1; back <= 3; ++back) {
+            const auto c = static_cast<unsigned char>(str[end - back]);
+            if ((c & 0xc0) != 0x80) {
+                const std::size_t length = c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : c >= 0xc0 ? 2 : 1;
+                return length > back ? end - back : end;
+            }
+        }
+        return end;
+    }
+
+    enum class cursor_kind { leaf, string, wide_string, container, pair, tuple, optional, variant, aggregate };
+
+    /** how ostream_impl prints T, see print_kind_of */
+    template <class T>
+    constexpr cursor_kind cursor_kind_of() {
+        constexpr print_kind kind = print_kind_of<chunk_writer, T>();
+        if constexpr (kind == print_kind::pair) {
+            return cursor_kind::pair;
+        } else if constexpr (kind == print_kind::tuple) {
+            return cursor_kind::tuple;
+        } else if constexpr (kind == print_kind::optional) {
+            return cursor_kind::optional;
+        } else if constexpr (kind == print_kind::variant) {
+            return cursor_kind::variant;
+        } else if constexpr (kind == print_kind::container) {
+            return cursor_kind::container;
+        } else if constexpr (kind == print_kind::wide_string) {
+            return cursor_kind::wide_string;
+        } else if constexpr (kind == print_kind::text) {
+            return std::is_same_v<decltype(quoted_helper(std::declval<const T&>())), quoted_view<char>>
+                       ? cursor_kind::string
+                       : cursor_kind::leaf;
+        } else if constexpr (kind == print_kind::aggregate) {
+            return cursor_kind::aggregate;
+        } else {
+            return cursor_kind::leaf;
+        }
+    }
+
+    /** position of the print of a T inside its text, with one nested cursor per level of T:
+     * resume(out, data) writes on from there and returns true once the text of data is complete */
+    template <class T, cursor_kind Kind = cursor_kind_of<T>()>
+    class cursor;
+
+    template <class T>
+    using cursor_of = cursor<std::remove_cv_t<T>>;
+
+    /** numbers, enums and types with their own operator<< are short:
+     * the text is rendered again when resumed and the bytes already sent are skipped */
+    template <class T>
+    class cursor<T, cursor_kind::leaf> {
+    public:
+        bool resume(chunk_writer& out, const T& data) {
+            return out.render(offset_, [&data](chunk_writer& w) { ostream::ostream_impl(w, data); });
+        }
+
+    private:
+        std::size_t offset_ = 0;
+    };
+
+    /** strings can be long, they are escaped in slices and resumed from the slice they stopped in */
+    template <class T>
+    class cursor<T, cursor_kind::string> {
+    public:
+        bool resume(chunk_writer& out, const T& data) {
+            const std::string_view str = quoted_helper(data).str;
+            if (!opened_) {
+                if (!out.piece(offset_, "\"")) {
+                    return false;
+                }
+                opened_ = true;
+            }
+            while (pos_ != str.size()) {
+                const std::size_t end = escape_slice_end(str, pos_);
+                const std::string_view slice = str.substr(pos_, end - pos_);
+                if (!out.render(offset_, [slice](chunk_writer& w) { write_escaped(w, slice); })) {
+                    return false;
+                }
+                pos_ = end;
+            }
+            return out.piece(offset_, "\"");
+        }
+
+    private:
+        std::size_t pos_ = 0;
+        std::size_t offset_ = 0;
+        bool opened_ = false;
+    };
+
+    /** wide strings are transcoded in the slices of write_quoted_utf, only the slice a buffer ended in is
+     * transcoded again */
+    template <class T>
+    class cursor<T, cursor_kind::wide_string> {
+        using view = decltype(quoted_wide(std::declval<const T&>()).str);
+
+    public:
+        bool resume(chunk_writer& out, const T& data) {
+            if (!opened_) {
+                if (!out.piece(offset_, "\"")) {
+                    return false;
+                }
+                // once: the length of a pointer is counted up to its null
+                str_ = quoted_wide(data).str;
+                opened_ = true;
+            }
+            const auto* const last = str_.data() + str_.size();
+            while (pos_ != str_.size()) {
+                const auto* const first = str_.data() + pos_;
+                const auto* const end = utf_slice_end(first, last);
+                if (!out.render(offset_, [first, end](chunk_writer& w) { write_quoted_units(w, first, end); })) {
+                    return false;
+                }
+                pos_ = static_cast<std::size_t>(end - str_.data());
+            }
+            return out.piece(offset_, "\"");
+        }
+
+    private:
+        view str_;
+        std::size_t pos_ = 0;
+        std::size_t offset_ = 0;
+        bool opened_ = false;
+    };
+
+    template <class T>
+    class cursor<T, cursor_kind::container> {
+        using iterator = decltype(std::begin(std::declval<const T&>()));
+        using element = std::remove_reference_t<decltype(*std::declval<iterator>())>;
+
+    public:
+        bool resume(chunk_writer& out, const T& data) {
+            if constexpr (is_contiguous_numbers_v<T>) {
+                // a number is at most 24 characters, a range that surely fits goes through write_numbers at once
+                if (!opened_ && 2 + static_cast<std::size_t>(std::size(data)) * (24 + 2) <= out.space()) {
+                    return out.render(offset_, [&data](chunk_writer& w) { ostream::ostream_impl(w, data); });
+                }
+            }
+            if (!opened_) {
+                if (!out.piece(offset_, is_map_v<T> ? "{" : "[")) {
+                    return false;
+                }
+                it_ = std::begin(data);
+                opened_ = true;
+            }
+            for (; it_ != std::end(data); ++it_, element_ = {}, delimited_ = false) {
+                if (!delimited_) {
+                    if (!out.piece(offset_, first_ ? "" : ", ")) {
+                        return false;
+                    }
+                    first_ = false;
+                    delimited_ = true;
+                }
+                if (!element_.resume(out, *it_)) {
+                    return false;
+                }
+            }
+            return out.piece(offset_, is_map_v<T> ? "}" : "]");
+        }
+
+    private:
+        iterator it_{};
+        cursor_of<element> element_;
+        std::size_t offset_ = 0;
+        bool opened_ = false;
+        bool first_ = true;
+        bool delimited_ = false;
+    };
+
+    template <class T>
+    class cursor<T, cursor_kind::pair> {
+    public:
+        bool resume(chunk_writer& out, const T& data) {
+            if (stage_ == 0) {
+                if (!first_.resume(out, data.first)) {
+                    return false;
+                }
+                stage_ = 1;
+            }
+            if (stage_ == 1) {
+                if (!out.piece(offset_, ": ")) {
+                    return false;
+                }
+                stage_ = 2;
+            }
+            return second_.resume(out, data.second);
+        }
+
+    private:
+        cursor_of<typename T::first_type> first_;
+        cursor_of<typename T::second_type> second_;
+        std::size_t offset_ = 0;
+        int stage_ = 0;
+    };
+
+    /** fields of a tuple or an aggregate between open and close, separated by ", " */
+    template <class Tuple, class Indices = std::make_index_sequence<std::tuple_size_v<Tuple>>>
+    class tuple_cursor;
+
+    template <class Tuple, std::size_t... Is>
+    class tuple_cursor<Tuple, std::index_sequence<Is...>> {
+    public:
+        bool resume(chunk_writer& out, const Tuple& data, std::string_view open, std::string_view close) {
+            if (stage_ == 0) {
+                if (!out.piece(offset_, open)) {
+                    return false;
+                }
+                stage_ = 1;
+            }
+            // stage 2i + 1 is the delimiter before field i, stage 2i + 2 the field
+            for (; stage_ <= 2 * sizeof...(Is); ++stage_) {
+                const std::size_t i = (stage_ - 1) / 2;
+                bool done = false;
+                if (stage_ % 2 == 1) {
+                    done = out.piece(offset_, i == 0 ? "" : ", ");
+                } else {
+                    ((void)(Is == i && (done = std::get<Is>(fields_).resume(out, std::get<Is>(data)))), ...);
+                }
+                if (!done) {
+                    return false;
+                }
+            }
+            return out.piece(offset_, close);
+        }
+
+    private:
+        std::tuple<cursor_of<std::remove_reference_t<std::tuple_element_t<Is, Tuple>>>...> fields_;
+        std::size_t offset_ = 0;
+        std::size_t stage_ = 0;
+    };
+
+    template <class T>
+    class cursor<T, cursor_kind::tuple> {
+    public:
+        bool resume(chunk_writer& out, const T& data) { return fields_.resume(out, data, "(", ")"); }
+
+    private:
+        tuple_cursor<T> fields_;
+    };
+
+    template <class T>
+    class cursor<T, cursor_kind::aggregate> {
+        using fields = decltype(tie_fields(std::declval<const T&>()));
+
+    public:
+        bool resume(chunk_writer& out, const T& data) { return fields_.resume(out, tie_fields(data), "{", "}"); }
+
+    private:
+        tuple_cursor<fields> fields_;
+    };
+
+#if __has_include(<optional>)
+    template <class T>
+    class cursor<T, cursor_kind::optional> {
+    public:
+        bool resume(chunk_writer& out, const T& data) {
+            return data ? value_.resume(out, *data) : out.piece(offset_, "null");
+        }
+
+    private:
+        cursor_of<typename T::value_type> value_;
+        std::size_t offset_ = 0;
+    };
+#endif
+
+#if __has_include(<variant>)
+    template <class... Ts>
+    class cursor<std::variant<Ts...>, cursor_kind::variant> {
+    public:
+        bool resume(chunk_writer& out, const std::variant<Ts...>& data) {
+            if (data.index() == std::variant_npos) {
+                return out.piece(offset_, "VARIANT_NPOS");
+            }
+            return resume(out, data, std::index_sequence_for<Ts...>{});
+        }
+
+    private:
+        template <std::size_t... Is>
+        bool resume(chunk_writer& out, const std::variant<Ts...>& data, std::index_sequence<Is...>) {
+            bool done = false;
+            ((void)(data.index() == Is && (done = std::get<Is>(alternatives_).resume(out, *std::get_if<Is>(&data)))),
+             ...);
+            return done;
+        }
+
+        std::tuple<cursor_of<Ts>...> alternatives_;
+        std::size_t offset_ = 0;
+    };
+#endif
+
+}  // namespace pretty::detail
+
+namespace pretty {
+
+    /** pretty data print written piece by piece into caller buffers, e.g. for a non-blocking socket
+     * every next() fills the buffer and the following one resumes at the same point of the traversal;
+     * the state is one cursor per nesting level of T, so memory does not depend on the size of the output
+     * data must outlive the formatter and stay unchanged until done() */
+    template <class T>
+    class chunked_formatter {
+    public:
+        explicit chunked_formatter(const T& data) noexcept : data_(data) {}
+
+        /** write the next part of the text, the same text as print(data), to buf
+         * @return the part written, as much as fits in size; empty once done() */
+        std::string_view next(char* buf, std::size_t size) {
+            if (done_) {
+                return {};
+            }
+            detail::chunk_writer out(buf, size);
+            done_ = cursor_.resume(out, data_);
+            return {buf, out.size()};
+        }
+
+        template <std::size_t N>
+        std::string_view next(char (&buf)[N]) {
+            return next(buf, N);
+        }
+
+        /** the whole text has been written */
+        bool done() const noexcept { return done_; }
+
+    private:
+        const T& data_;
+        detail::cursor_of<T> cursor_;
+        bool done_ = false;
+    };
+
+}  // namespace pretty
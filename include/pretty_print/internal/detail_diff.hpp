@@ -0,0 +1,332 @@
+#pragma once
+#include <cstddef>      // std::size_t
+#include <iterator>     // std::begin, std::end
+#include <string>       // std::string, std::to_string
+#include <string_view>  // std::string_view
+#include <tuple>        // std::tuple_size_v, std::get
+#include <type_traits>  // std::void_t, std::is_convertible_v, std::decay_t
+#include <utility>      // std::index_sequence
+#include <vector>       // std::vector
+
+#include "detail_visit.hpp"
+
+namespace pretty::detail {
+
+    template <typename T, typename = void>
+    struct has_equal : std::false_type {};
+    template <typename T>
+    struct has_equal<T, std::void_t<decltype(std::declval<const T&>() == std::declval<const T&>())>>
+        : std::is_convertible<decltype(std::declval<const T&>() == std::declval<const T&>()), bool> {};
+
+    template <typename T, typename = void>
+    struct is_ordered_associative : std::false_type {};
+    template <typename T>
+    struct is_ordered_associative<T, std::void_t<typename T::key_type, typename T::key_compare>> : std::true_type {};
+
+    template <typename T, typename = void>
+    struct is_set : std::false_type {};
+    template <typename T>
+    struct is_set<T, std::void_t<typename T::key_type, decltype(std::declval<const T&>().find(
+                                                           std::declval<const typename T::key_type&>()))>>
+        : std::is_same<typename T::key_type, typename T::value_type> {};
+
+    /** character pointers and arrays, printed as the text up to the terminating null */
+    template <typename T>
+    inline constexpr bool is_char_text_v =
+        (std::is_pointer_v<T> || std::is_array_v<T>) &&
+        is_char_type_v<std::remove_cv_t<std::remove_pointer_t<std::decay_t<T>>>>;
+
+    /** walks two values of the same type together with the dispatch of ostream::ostream_impl and prints
+     * only what differs, one line per difference:
+     *   path: old -> new    a value changed
+     *   path: + new         a map entry, set element or trailing sequence element is only in the second value
+     *   path: - old         ... only in the first value
+     * path is [index] for sequences, [key] for maps and .index for tuple, pair and aggregate members;
+     * containers are compared element by element and nothing equal is formatted */
+    template <class Stream>
+    class differ {
+    public:
+        explicit differ(Stream& out) noexcept : out_(out) {}
+
+        template <class T>
+        void compare(const T& a, const T& b) {
+            constexpr bool has_operator = has_ostream_operator_v<std::ostream, T>;
+            if constexpr (is_pair<T>::value && !has_operator) {
+                member(0, a.first, b.first);
+                member(1, a.second, b.second);
+            } else if constexpr (is_tuple<T>::value && !has_operator) {
+                compare_members(a, b, std::make_index_sequence<std::tuple_size_v<T>>{});
+            } else if constexpr (is_optional<T>::value && !has_operator) {
+                if (a && b) {
+                    compare(*a, *b);
+                } else if (a || b) {
+                    changed(a, b);
+                }
+            } else if constexpr (is_variant<T>::value) {
+                if (a.index() != b.index()) {
+                    changed(a, b);
+                } else {
+                    compare_variant<0>(a, b);
+                }
+            } else if constexpr (is_char_text_v<T>) {
+                if (!is_same_text(a, b)) {
+                    changed(a, b);
+                }
+            } else if constexpr (is_iterable_v<T> && !is_c_string_v<T> && !is_wide_string_v<T> &&
+                                 (!has_operator || std::is_array_v<T>)) {
+                if constexpr (is_map_v<T>) {
+                    compare_map(a, b);
+                } else if constexpr (is_set<T>::value) {
+                    compare_set(a, b);
+                } else {
+                    compare_sequence(a, b);
+                }
+            } else if constexpr (is_plain_aggregate_v<T> && !has_operator) {
+                const auto fields_a = tie_fields(a);
+                const auto fields_b = tie_fields(b);
+                compare_members(fields_a, fields_b,
+                                std::make_index_sequence<std::tuple_size_v<std::decay_t<decltype(fields_a)>>>{});
+            } else if constexpr (has_equal<T>::value) {
+                if (!(a == b)) {
+                    changed(a, b);
+                }
+            } else if (to_text(a) != to_text(b)) {
+                changed(a, b);
+            }
+        }
+
+    private:
+        /** fast path for numbers and strings, whose operator== is the whole comparison;
+         * false for other types, which are then compared by compare() */
+        template <class T>
+        static bool is_leaf_equal(const T& a, const T& b) {
+            if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T> || is_std_string<T>::value) {
+                return a == b;
+            } else {
+                return false;
+            }
+        }
+
+        /** compares the text two character pointers point to; signed and unsigned char as char, like std::ostream */
+        template <class C>
+        static bool is_same_text(const C* a, const C* b) noexcept {
+            if (a == nullptr || b == nullptr) {
+                return a == b;
+            }
+            if constexpr (is_same_any_of_v<C, signed char, unsigned char>) {
+                return std::string_view(reinterpret_cast<const char*>(a)) ==
+                       std::string_view(reinterpret_cast<const char*>(b));
+            } else {
+                return std::basic_string_view<C>(a) == std::basic_string_view<C>(b);
+            }
+        }
+
+        /** one step of the path, formatted only when a difference below it is printed */
+        struct step {
+            void (*write)(std::string& path, const void* key, std::size_t index);
+            const void* key;
+            std::size_t index;
+        };
+
+        static void write_index(std::string& path, const void*, std::size_t index) {
+            path += '[';
+            path += std::to_string(index);
+            path += ']';
+        }
+
+        static void write_member(std::string& path, const void*, std::size_t index) {
+            path += '.';
+            path += std::to_string(index);
+        }
+
+        template <class Key>
+        static void write_key(std::string& path, const void* key, std::size_t) {
+            path += '[';
+            {
+                string_writer<std::string> writer(path);
+                ostream::ostream_impl(writer, quoted_helper(*static_cast<const Key*>(key)));
+            }
+            path += ']';
+        }
+
+        /** pushes a step, popped when the guard goes out of scope */
+        class path_guard {
+        public:
+            path_guard(std::vector<step>& path, step next) : path_(path) { path_.push_back(next); }
+            ~path_guard() { path_.pop_back(); }
+
+            path_guard(const path_guard&) = delete;
+            path_guard& operator=(const path_guard&) = delete;
+
+        private:
+            std::vector<step>& path_;
+        };
+
+        path_guard index_step(std::size_t index) { return path_guard(path_, {&write_index, nullptr, index}); }
+
+        template <class Key>
+        path_guard key_step(const Key& key) {
+            return path_guard(path_, {&write_key<Key>, &key, 0});
+        }
+
+        template <class T>
+        void member(std::size_t index, const T& a, const T& b) {
+            path_guard guard(path_, {&write_member, nullptr, index});
+            compare(a, b);
+        }
+
+        template <class Tuple, std::size_t... Is>
+        void compare_members(const Tuple& a, const Tuple& b, std::index_sequence<Is...>) {
+            (member(Is, std::get<Is>(a), std::get<Is>(b)), ...);
+        }
+
+        template <std::size_t I, class Variant>
+        void compare_variant(const Variant& a, const Variant& b) {
+            if constexpr (I < std::variant_size_v<Variant>) {
+                if (a.index() == I) {
+                    compare(std::get<I>(a), std::get<I>(b));
+                } else {
+                    compare_variant<I + 1>(a, b);
+                }
+            }
+        }
+
+        template <class T>
+        void compare_sequence(const T& a, const T& b) {
+            auto it_a = std::begin(a);
+            auto it_b = std::begin(b);
+            const auto last_a = std::end(a);
+            const auto last_b = std::end(b);
+            std::size_t index = 0;
+            for (; it_a != last_a && it_b != last_b; ++it_a, ++it_b, ++index) {
+                if (!is_leaf_equal(*it_a, *it_b)) {
+                    const path_guard guard = index_step(index);
+                    compare(*it_a, *it_b);
+                }
+            }
+            for (; it_a != last_a; ++it_a, ++index) {
+                const path_guard guard = index_step(index);
+                line('-', *it_a);
+            }
+            for (; it_b != last_b; ++it_b, ++index) {
+                const path_guard guard = index_step(index);
+                line('+', *it_b);
+            }
+        }
+
+        /** sorted merge for ordered maps, lookups into the other map for unordered ones */
+        template <class T>
+        void compare_map(const T& a, const T& b) {
+            if constexpr (is_ordered_associative<T>::value) {
+                const auto less = a.key_comp();
+                auto it_a = a.begin();
+                auto it_b = b.begin();
+                while (it_a != a.end() || it_b != b.end()) {
+                    if (it_a != a.end() && it_b != b.end() && is_leaf_equal(it_a->first, it_b->first)) {
+                        if (!is_leaf_equal(it_a->second, it_b->second)) {
+                            const path_guard guard = key_step(it_a->first);
+                            compare(it_a->second, it_b->second);
+                        }
+                        ++it_a;
+                        ++it_b;
+                    } else if (it_b == b.end() || (it_a != a.end() && less(it_a->first, it_b->first))) {
+                        const path_guard guard = key_step(it_a->first);
+                        line('-', it_a->second);
+                        ++it_a;
+                    } else if (it_a == a.end() || less(it_b->first, it_a->first)) {
+                        const path_guard guard = key_step(it_b->first);
+                        line('+', it_b->second);
+                        ++it_b;
+                    } else {
+                        const path_guard guard = key_step(it_a->first);
+                        compare(it_a->second, it_b->second);
+                        ++it_a;
+                        ++it_b;
+                    }
+                }
+            } else {
+                for (const auto& [key, value] : a) {
+                    const path_guard guard = key_step(key);
+                    const auto it = b.find(key);
+                    if (it == b.end()) {
+                        line('-', value);
+                    } else {
+                        compare(value, it->second);
+                    }
+                }
+                for (const auto& [key, value] : b) {
+                    if (a.find(key) == a.end()) {
+                        const path_guard guard = key_step(key);
+                        line('+', value);
+                    }
+                }
+            }
+        }
+
+        /** set elements are their own keys: only additions and removals */
+        template <class T>
+        void compare_set(const T& a, const T& b) {
+            if constexpr (is_ordered_associative<T>::value) {
+                const auto less = a.key_comp();
+                auto it_a = a.begin();
+                auto it_b = b.begin();
+                while (it_a != a.end() || it_b != b.end()) {
+                    if (it_b == b.end() || (it_a != a.end() && less(*it_a, *it_b))) {
+                        line('-', *it_a++);
+                    } else if (it_a == a.end() || less(*it_b, *it_a)) {
+                        line('+', *it_b++);
+                    } else {
+                        ++it_a;
+                        ++it_b;
+                    }
+                }
+            } else {
+                for (const auto& el : a) {
+                    if (b.find(el) == b.end()) {
+                        line('-', el);
+                    }
+                }
+                for (const auto& el : b) {
+                    if (a.find(el) == a.end()) {
+                        line('+', el);
+                    }
+                }
+            }
+        }
+
+        void write_path() {
+            if (path_.empty()) {
+                return;
+            }
+            text_.clear();
+            for (const step& s : path_) {
+                s.write(text_, s.key, s.index);
+            }
+            append(out_, std::string_view(text_));
+            append(out_, ": ");
+        }
+
+        template <class T>
+        void line(char sign, const T& value) {
+            write_path();
+            append(out_, sign);
+            append(out_, ' ');
+            ostream::ostream_impl(out_, quoted_helper(value));
+            append(out_, '\n');
+        }
+
+        template <class T>
+        void changed(const T& a, const T& b) {
+            write_path();
+            ostream::ostream_impl(out_, quoted_helper(a));
+            append(out_, " -> ");
+            ostream::ostream_impl(out_, quoted_helper(b));
+            append(out_, '\n');
+        }
+
+        Stream& out_;
+        std::vector<step> path_;
+        std::string text_;
+    };
+
+}  // namespace pretty::detail
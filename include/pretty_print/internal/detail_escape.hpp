@@ -0,0 +1,295 @@
+#pragma once
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint32_t
+#include <cstring>      // std::memcpy
+#include <ostream>      // std::ostream
+#include <string_view>  // std::string_view
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PRETTY_PRINT_HAS_SSE2 1
+#include <emmintrin.h>  // _mm_loadu_si128
+#endif
+#if defined(PRETTY_PRINT_HAS_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define PRETTY_PRINT_HAS_AVX2 1
+#include <immintrin.h>  // _mm256_loadu_si256
+#endif
+
+namespace pretty::detail {
+
+    /** true for bytes that can not be copied into a quoted string as is:
+     * the delimiter, the escape character, control characters and everything outside ASCII */
+    constexpr bool is_escape_candidate(unsigned char c) noexcept {
+        return c < 0x20 || c >= 0x7f || c == '"' || c == '\\';
+    }
+
+    /** first byte in [first, last) that is an escape candidate, or last */
+    using find_escape_fn = const char* (*)(const char* first, const char* last) noexcept;
+
+    inline const char* find_escape_scalar(const char* first, const char* last) noexcept {
+        for (; first != last; ++first) {
+            if (is_escape_candidate(static_cast<unsigned char>(*first))) {
+                break;
+            }
+        }
+        return first;
+    }
+
+    inline unsigned count_trailing_zeros(std::uint32_t mask) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+        unsigned n = 0;
+        for (; !(mask & 1u); mask >>= 1) ++n;
+        return n;
+#endif
+    }
+
+#if defined(PRETTY_PRINT_HAS_SSE2)
+    inline const char* find_escape_sse2(const char* first, const char* last) noexcept {
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i del = _mm_set1_epi8(0x7f);
+        const __m128i space = _mm_set1_epi8(0x20);
+        for (; last - first >= 16; first += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            // signed compare: bytes >= 0x80 are negative and land in "less than space" together with controls
+            const __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                                                 _mm_or_si128(_mm_cmpeq_epi8(v, del), _mm_cmplt_epi8(v, space)));
+            const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(special));
+            if (mask != 0) {
+                return first + count_trailing_zeros(mask);
+            }
+        }
+        return find_escape_scalar(first, last);
+    }
+#endif
+
+#if defined(PRETTY_PRINT_HAS_AVX2)
+    __attribute__((target("avx2"))) inline const char* find_escape_avx2(const char* first,
+                                                                        const char* last) noexcept {
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i del = _mm256_set1_epi8(0x7f);
+        const __m256i control = _mm256_set1_epi8(0x1f);
+        for (; last - first >= 32; first += 32) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            // signed compare: bytes >= 0x80 are negative and land in "not greater than 0x1f" together with controls
+            const __m256i special =
+                _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+                                _mm256_or_si256(_mm256_cmpeq_epi8(v, del), _mm256_cmpgt_epi8(control, v)));
+            const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(special));
+            if (mask != 0) {
+                return first + count_trailing_zeros(mask);
+            }
+        }
+        return find_escape_sse2(first, last);
+    }
+#endif
+
+    /** widest kernel supported by the running CPU, resolved once */
+    inline find_escape_fn find_escape() noexcept {
+        static const find_escape_fn fn = [] {
+#if defined(PRETTY_PRINT_HAS_AVX2)
+            if (__builtin_cpu_supports("avx2")) {
+                return &find_escape_avx2;
+            }
+#endif
+#if defined(PRETTY_PRINT_HAS_SSE2)
+            return &find_escape_sse2;
+#else
+            return &find_escape_scalar;
+#endif
+        }();
+        return fn;
+    }
+
+    /** length of the valid UTF-8 sequence starting at first, 0 if it is not valid */
+    constexpr std::size_t utf8_sequence_size(const char* first, const char* last) noexcept {
+        const auto byte = [first](std::size_t i) { return static_cast<unsigned char>(first[i]); };
+        const auto avail = static_cast<std::size_t>(last - first);
+        const auto is_continuation = [&](std::size_t i, unsigned char lo = 0x80, unsigned char hi = 0xbf) {
+            return i < avail && byte(i) >= lo && byte(i) <= hi;
+        };
+        const unsigned char lead = byte(0);
+        if (lead >= 0xc2 && lead <= 0xdf) {
+            return is_continuation(1) ? 2 : 0;
+        }
+        if (lead >= 0xe0 && lead <= 0xef) {
+            const bool second = lead == 0xe0   ? is_continuation(1, 0xa0, 0xbf)
+                                : lead == 0xed ? is_continuation(1, 0x80, 0x9f)
+                                               : is_continuation(1);
+            return second && is_continuation(2) ? 3 : 0;
+        }
+        if (lead >= 0xf0 && lead <= 0xf4) {
+            const bool second = lead == 0xf0   ? is_continuation(1, 0x90, 0xbf)
+                                : lead == 0xf4 ? is_continuation(1, 0x80, 0x8f)
+                                               : is_continuation(1);
+            return second && is_continuation(2) && is_continuation(3) ? 4 : 0;
+        }
+        return 0;
+    }
+
+    /** escape sequence of write_quoted for the escape candidate c that is not part of a valid UTF-8 sequence,
+     * also used in constant expressions, see static_write_quoted
+     * @return end of the 2 or 4 characters written to out */
+    constexpr char* escape_byte(unsigned char c, char* out) noexcept {
+        constexpr char hex[] = "0123456789abcdef";
+        *out++ = '\\';
+        switch (c) {
+            case '"':
+            case '\\':
+                *out++ = static_cast<char>(c);
+                break;
+            case '\b':
+                *out++ = 'b';
+                break;
+            case '\f':
+                *out++ = 'f';
+                break;
+            case '\n':
+                *out++ = 'n';
+                break;
+            case '\r':
+                *out++ = 'r';
+                break;
+            case '\t':
+                *out++ = 't';
+                break;
+            default:
+                *out++ = 'x';
+                *out++ = hex[c >> 4];
+                *out++ = hex[c & 0xf];
+        }
+        return out;
+    }
+
+    /** write str escaped as write_quoted does, without the quotes */
+    template <class Writer>
+    void write_escaped(Writer& out, std::string_view str) {
+        const find_escape_fn find = find_escape();
+        const char* run = str.data();
+        const char* const last = str.data() + str.size();
+        for (const char* it = find(run, last); it != last; it = find(it, last)) {
+            const auto c = static_cast<unsigned char>(*it);
+            if (c >= 0x80) {
+                if (const std::size_t n = utf8_sequence_size(it, last)) {
+                    it += n;
+                    continue;
+                }
+            }
+            out.write(run, static_cast<std::size_t>(it - run));
+            char escaped[4];
+            out.write(escaped, static_cast<std::size_t>(escape_byte(c, escaped) - escaped));
+            run = ++it;
+        }
+        out.write(run, static_cast<std::size_t>(last - run));
+    }
+
+    /** write str in double quotes: " and \ are escaped with a backslash as std::quoted does,
+     * control characters become \n, \t, ... or \xHH, bytes that are not valid UTF-8 become \xHH
+     * clean runs, valid multibyte sequences included, are passed to the writer in one call */
+    template <class Writer>
+    void write_quoted(Writer& out, std::string_view str) {
+        out.put('"');
+        write_escaped(out, str);
+        out.put('"');
+    }
+
+    /** write str as a JSON string: " and \ are escaped with a backslash, control characters become \n, \t, ...
+     * or \u00XX, bytes that are not valid UTF-8 become U+FFFD, so the output is always valid UTF-8 */
+    template <class Writer>
+    void write_json_string(Writer& out, std::string_view str) {
+        static constexpr char hex[] = "0123456789abcdef";
+        const find_escape_fn find = find_escape();
+        const char* run = str.data();
+        const char* const last = str.data() + str.size();
+        out.put('"');
+        for (const char* it = find(run, last); it != last; it = find(it, last)) {
+            const auto c = static_cast<unsigned char>(*it);
+            if (c == 0x7f) {
+                ++it;
+                continue;
+            }
+            if (c >= 0x80) {
+                if (const std::size_t n = utf8_sequence_size(it, last)) {
+                    it += n;
+                    continue;
+                }
+                out.write(run, static_cast<std::size_t>(it - run));
+                out.write("\xef\xbf\xbd", 3);
+                run = ++it;
+                continue;
+            }
+            out.write(run, static_cast<std::size_t>(it - run));
+            char escaped[6] = {'\\', static_cast<char>(c), '0', '0', 0, 0};
+            std::size_t size = 2;
+            switch (c) {
+                case '"':
+                case '\\':
+                    break;
+                case '\b':
+                    escaped[1] = 'b';
+                    break;
+                case '\f':
+                    escaped[1] = 'f';
+                    break;
+                case '\n':
+                    escaped[1] = 'n';
+                    break;
+                case '\r':
+                    escaped[1] = 'r';
+                    break;
+                case '\t':
+                    escaped[1] = 't';
+                    break;
+                default:
+                    escaped[1] = 'u';
+                    escaped[4] = hex[c >> 4];
+                    escaped[5] = hex[c & 0xf];
+                    size = 6;
+            }
+            out.write(escaped, size);
+            run = ++it;
+        }
+        out.write(run, static_cast<std::size_t>(last - run));
+        out.put('"');
+    }
+
+    /** small stack buffer in front of a std::ostream, for many short writes */
+    class ostream_buffer {
+    public:
+        explicit ostream_buffer(std::ostream& out) noexcept : out_(out) {}
+        ~ostream_buffer() { flush(); }
+
+        ostream_buffer(const ostream_buffer&) = delete;
+        ostream_buffer& operator=(const ostream_buffer&) = delete;
+
+        void write(const char* s, std::size_t n) {
+            if (n > sizeof(buf_) - size_) {
+                flush();
+                if (n > sizeof(buf_)) {
+                    out_.write(s, static_cast<std::streamsize>(n));
+                    return;
+                }
+            }
+            std::memcpy(buf_ + size_, s, n);
+            size_ += n;
+        }
+        void put(char c) {
+            if (size_ == sizeof(buf_)) {
+                flush();
+            }
+            buf_[size_++] = c;
+        }
+        void flush() {
+            out_.write(buf_, static_cast<std::streamsize>(size_));
+            size_ = 0;
+        }
+
+    private:
+        std::ostream& out_;
+        std::size_t size_ = 0;
+        char buf_[512];
+    };
+
+}  // namespace pretty::detail
@@ -0,0 +1,139 @@
+#pragma once
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint64_t, std::uintptr_t
+#include <memory>       // std::shared_ptr, std::unique_ptr, std::weak_ptr
+#include <type_traits>  // std::declval, std::is_same_v, std::void_t
+#include <utility>      // std::move, std::pair
+
+namespace pretty {
+
+    /** pointers, shared_ptr, unique_ptr and weak_ptr printed as what they point to: the first time an object
+     * is reached it prints as "#N value", every later time, through a shared subobject or a cycle, as "<ref #N>",
+     * so the output is linear in the number of distinct objects; null and expired pointers print as null */
+    struct deref_pointers {};
+
+}  // namespace pretty
+
+namespace pretty::detail {
+
+    template <typename T>
+    struct pointee_of {
+        using type = void;
+    };
+    template <typename T>
+    struct pointee_of<T*> {
+        using type = T;
+    };
+    template <typename T>
+    struct pointee_of<std::shared_ptr<T>> {
+        using type = T;
+    };
+    template <typename T, typename D>
+    struct pointee_of<std::unique_ptr<T, D>> {
+        using type = T;
+    };
+    template <typename T>
+    struct pointee_of<std::weak_ptr<T>> {
+        using type = T;
+    };
+
+    template <typename T, typename U = std::remove_cv_t<T>>
+    inline constexpr bool is_character_v = std::is_same_v<U, char> || std::is_same_v<U, signed char> ||
+                                           std::is_same_v<U, unsigned char> || std::is_same_v<U, char16_t> ||
+                                           std::is_same_v<U, char32_t> || std::is_same_v<U, wchar_t>;
+
+    /** pointers and smart pointers to single objects; character pointers stay strings, void and function
+     * pointers stay addresses */
+    template <typename T>
+    inline constexpr bool is_object_pointer_v =
+        std::is_object_v<typename pointee_of<T>::type> && !std::is_array_v<typename pointee_of<T>::type> &&
+        !is_character_v<typename pointee_of<T>::type>;
+
+    template <typename T>
+    struct is_weak_ptr : std::false_type {};
+    template <typename T>
+    struct is_weak_ptr<std::weak_ptr<T>> : std::true_type {};
+
+    /** one address per type without cv-qualifiers, objects at the same address with different types,
+     * e.g. a struct and its first member, are different nodes */
+    template <typename T>
+    inline constexpr char type_tag = 0;
+
+    /** open addressing set of the objects printed so far, numbered in the order they were added
+     * 16 slots live inline, the table doubles past half full */
+    class address_set {
+    public:
+        address_set() noexcept = default;
+        address_set(const address_set&) = delete;
+        address_set& operator=(const address_set&) = delete;
+
+        /** @return the number of the object and true if it was added by this call */
+        std::pair<std::size_t, bool> insert(const void* address, const void* type) {
+            if (2 * (size_ + 1) > capacity_) {
+                grow();
+            }
+            for (std::size_t i = slot(address, type);; i = (i + 1) & (capacity_ - 1)) {
+                entry& e = slots_[i];
+                if (e.address == nullptr) {
+                    e = {address, type, ++size_};
+                    return {size_, true};
+                }
+                if (e.address == address && e.type == type) {
+                    return {e.id, false};
+                }
+            }
+        }
+
+    private:
+        struct entry {
+            const void* address;
+            const void* type;
+            std::size_t id;
+        };
+
+        static constexpr std::size_t inline_capacity = 16;
+
+        std::size_t slot(const void* address, const void* type) const noexcept {
+            const auto key = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(address)) ^
+                             static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(type) >> 3);
+            return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ull) >> shift_);
+        }
+
+        void grow() {
+            const std::size_t capacity = 2 * capacity_;
+            std::unique_ptr<entry[]> heap(new entry[capacity]());
+            entry* const old = slots_;
+            const std::size_t old_capacity = capacity_;
+            slots_ = heap.get();
+            capacity_ = capacity;
+            --shift_;
+            for (std::size_t i = 0; i != old_capacity; ++i) {
+                if (old[i].address != nullptr) {
+                    std::size_t j = slot(old[i].address, old[i].type);
+                    for (; slots_[j].address != nullptr; j = (j + 1) & (capacity_ - 1)) {
+                    }
+                    slots_[j] = old[i];
+                }
+            }
+            heap_ = std::move(heap);
+        }
+
+        entry inline_[inline_capacity] = {};
+        entry* slots_ = inline_;
+        std::size_t capacity_ = inline_capacity;
+        /** 64 - log2(capacity_), the top bits of the product pick the slot */
+        unsigned shift_ = 60;
+        std::size_t size_ = 0;
+        std::unique_ptr<entry[]> heap_;
+    };
+
+    template <typename Stream, typename = void>
+    struct is_graph_writer : std::false_type {};
+    template <typename Stream>
+    struct is_graph_writer<Stream, std::void_t<decltype(std::declval<Stream&>().visited())>> : std::true_type {};
+
+    /** writers with visited() print pointers as their pointees, see graph_writer */
+    template <typename Stream>
+    inline constexpr bool is_graph_writer_v = is_graph_writer<Stream>::value;
+
+}  // namespace pretty::detail
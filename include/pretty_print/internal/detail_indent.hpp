@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>      // std::size_t
+#include <type_traits>  // std::declval, std::void_t
+
+namespace pretty {
+
+    /** multi-line output: every container element on its own line, indented by its nesting depth */
+    struct indent {
+        /** spaces per nesting level */
+        std::size_t width = 2;
+        /** containers whose single-line text is at most this long stay on one line, 0 to never keep them */
+        std::size_t inline_width = 0;
+    };
+
+}  // namespace pretty
+
+namespace pretty::detail {
+
+    template <typename Stream, typename = void>
+    struct is_indent_writer : std::false_type {};
+    template <typename Stream>
+    struct is_indent_writer<Stream, std::void_t<decltype(std::declval<const Stream&>().multiline())>>
+        : std::true_type {};
+
+    /** writers with multiline() print containers over several lines while it is true, see indent_writer */
+    template <typename Stream>
+    inline constexpr bool is_indent_writer_v = is_indent_writer<Stream>::value;
+
+}  // namespace pretty::detail
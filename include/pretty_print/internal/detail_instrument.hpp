@@ -0,0 +1,368 @@
+#pragma once
+#include <algorithm>    // std::max, std::min
+#include <atomic>       // std::atomic
+#include <chrono>       // std::chrono::steady_clock
+#include <cstddef>      // std::size_t
+#include <cstring>      // std::memcpy
+#include <optional>     // std::optional
+#include <ostream>      // std::ostream
+#include <streambuf>    // std::streambuf
+#include <type_traits>  // std::conditional_t, std::is_base_of_v, std::void_t
+
+namespace pretty {
+
+    /** cost of print calls, see instrumentation */
+    struct print_stats {
+        /** top-level print, print_line, print_args and format_to calls */
+        std::size_t calls = 0;
+        /** values visited: containers, their elements and scalars */
+        std::size_t elements = 0;
+        /** characters written to std::ostream and std::string outputs */
+        std::size_t bytes = 0;
+        /** deepest container nesting reached */
+        std::size_t max_depth = 0;
+        /** heap allocations, counted by the function installed with instrumentation::allocation_counter */
+        std::size_t allocations = 0;
+        /** wall time */
+        std::chrono::nanoseconds time{0};
+
+        print_stats& operator+=(const print_stats& other) noexcept {
+            calls += other.calls;
+            elements += other.elements;
+            bytes += other.bytes;
+            max_depth = std::max(max_depth, other.max_depth);
+            allocations += other.allocations;
+            time += other.time;
+            return *this;
+        }
+    };
+
+    /** one top-level call, passed to the instrumentation callback */
+    struct print_record {
+        /** label of the innermost print_label scope on the calling thread, nullptr outside of one */
+        const char* label;
+        print_stats stats;
+    };
+
+}  // namespace pretty
+
+namespace pretty::detail {
+
+    struct instrument_globals {
+        std::atomic<void (*)(const print_record&)> callback{nullptr};
+        std::atomic<std::size_t (*)()> allocation_counter{nullptr};
+    };
+
+    inline instrument_globals& instrument_config() noexcept {
+        static instrument_globals config;
+        return config;
+    }
+
+    /** per-thread totals, the stats of the running top-level call and the label and nesting of print calls;
+     * sizing is set while formatted_size measures a result ahead of the print that writes it */
+    struct instrument_thread {
+        print_stats total;
+        print_stats call;
+        const char* label = nullptr;
+        std::size_t nesting = 0;
+        bool sizing = false;
+    };
+
+    inline instrument_thread& instrument_state() noexcept {
+        thread_local instrument_thread state;
+        return state;
+    }
+
+}  // namespace pretty::detail
+
+namespace pretty {
+
+    /** opt-in cost accounting of print calls, compiled in when PRETTY_PRINT_INSTRUMENTATION is defined before
+     * pretty_print.hpp is included, in every translation unit; otherwise the hooks are empty and cost nothing
+     * every top-level print, print_line, print_args and format_to call is measured on its own: nested calls,
+     * e.g. the print calls of print_line, count towards the call that contains them */
+    class instrumentation {
+    public:
+#if defined(PRETTY_PRINT_INSTRUMENTATION)
+        static constexpr bool enabled = true;
+#else
+        static constexpr bool enabled = false;
+#endif
+
+        /** fn is called after every top-level call, on the thread that made it; nullptr to stop */
+        static void callback(void (*fn)(const print_record& record)) noexcept {
+            detail::instrument_config().callback.store(fn, std::memory_order_relaxed);
+        }
+
+        /** fn returns the number of heap allocations so far, e.g. from a replaced operator new;
+         * print_stats::allocations stays 0 without it */
+        static void allocation_counter(std::size_t (*fn)()) noexcept {
+            detail::instrument_config().allocation_counter.store(fn, std::memory_order_relaxed);
+        }
+
+        /** totals of the top-level calls made by the calling thread since the last reset */
+        static const print_stats& thread_stats() noexcept { return detail::instrument_state().total; }
+
+        static void reset_thread_stats() noexcept { detail::instrument_state().total = print_stats{}; }
+    };
+
+    /** labels the print calls made in its scope on the calling thread, e.g. with the name of a log statement;
+     * label must outlive the scope */
+    class print_label {
+    public:
+        explicit print_label([[maybe_unused]] const char* label) noexcept {
+#if defined(PRETTY_PRINT_INSTRUMENTATION)
+            previous_ = detail::instrument_state().label;
+            detail::instrument_state().label = label;
+#endif
+        }
+        ~print_label() {
+#if defined(PRETTY_PRINT_INSTRUMENTATION)
+            detail::instrument_state().label = previous_;
+#endif
+        }
+
+        print_label(const print_label&) = delete;
+        print_label& operator=(const print_label&) = delete;
+
+    private:
+        const char* previous_ = nullptr;
+    };
+
+}  // namespace pretty
+
+namespace pretty::detail {
+
+#if defined(PRETTY_PRINT_INSTRUMENTATION)
+    /** a value printed at depth */
+    inline void instrument_value(std::size_t depth) noexcept {
+        instrument_thread& state = instrument_state();
+        if (state.sizing) {
+            return;
+        }
+        print_stats& call = state.call;
+        ++call.elements;
+        call.max_depth = std::max(call.max_depth, depth);
+    }
+
+    /** n values printed at depth without visiting them one by one */
+    inline void instrument_values(std::size_t n, std::size_t depth) noexcept {
+        instrument_thread& state = instrument_state();
+        if (state.sizing) {
+            return;
+        }
+        print_stats& call = state.call;
+        call.elements += n;
+        call.max_depth = std::max(call.max_depth, depth);
+    }
+
+    /** values visited during its lifetime are not counted, see formatted_size */
+    class instrument_sizing {
+    public:
+        instrument_sizing() noexcept : previous_(instrument_state().sizing) { instrument_state().sizing = true; }
+        ~instrument_sizing() { instrument_state().sizing = previous_; }
+
+        instrument_sizing(const instrument_sizing&) = delete;
+        instrument_sizing& operator=(const instrument_sizing&) = delete;
+
+    private:
+        bool previous_;
+    };
+
+    /** buffered streambuf in front of another one, counting the characters passed through */
+    class counting_streambuf : public std::streambuf {
+    public:
+        counting_streambuf() noexcept { setp(buf_, buf_ + sizeof(buf_)); }
+
+        void target(std::streambuf* target) noexcept { target_ = target; }
+
+        /** characters written so far, buffered ones included */
+        std::size_t count() const noexcept { return count_ + static_cast<std::size_t>(pptr() - pbase()); }
+
+        /** pass the buffered characters on without syncing the target */
+        bool flush() {
+            const std::streamsize n = pptr() - pbase();
+            const std::streamsize written = target_->sputn(pbase(), n);
+            count_ += static_cast<std::size_t>(written);
+            setp(buf_, buf_ + sizeof(buf_));
+            return written == n;
+        }
+
+    protected:
+        int_type overflow(int_type ch) override {
+            if (!flush()) {
+                return traits_type::eof();
+            }
+            if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(ch);
+                pbump(1);
+            }
+            return traits_type::not_eof(ch);
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override {
+            if (n <= epptr() - pptr()) {
+                std::memcpy(pptr(), s, static_cast<std::size_t>(n));
+                pbump(static_cast<int>(n));
+                return n;
+            }
+            if (!flush()) {
+                return 0;
+            }
+            const std::streamsize written = target_->sputn(s, n);
+            count_ += static_cast<std::size_t>(written);
+            return written;
+        }
+
+        int sync() override { return flush() ? target_->pubsync() : -1; }
+
+    private:
+        std::streambuf* target_ = nullptr;
+        std::size_t count_ = 0;
+        char buf_[256];
+    };
+
+    template <typename T, typename = void>
+    struct has_size_member : std::false_type {};
+    template <typename T>
+    struct has_size_member<T, std::void_t<decltype(std::declval<const T&>().size())>> : std::true_type {};
+
+    /** std::ostream of one top-level call, formatted as the stream the caller passed, its iword, pword and
+     * exception mask included, and writing to its streambuf through a counting_streambuf; the caller's stream
+     * itself is left alone, so that threads printing to a shared one, e.g. std::cerr, do not race on it */
+    class counting_ostream : public std::ostream {
+    public:
+        explicit counting_ostream(std::ostream& target) : std::ostream(&buf_) {
+            buf_.target(target.rdbuf());
+            copyfmt(target);
+            clear(target.rdstate());
+        }
+
+        counting_streambuf& buf() noexcept { return buf_; }
+
+    private:
+        counting_streambuf buf_;
+    };
+
+    /** the stream a top-level call writes to: std::ostream ones print through a counting_ostream */
+    template <class Out>
+    using instrumented_t = std::conditional_t<std::is_base_of_v<std::ostream, Out>, std::ostream, Out>;
+
+    /** measures the top-level print call writing to out during its lifetime, nested calls pass through;
+     * std::ostream output is counted by the counting_ostream the call writes to, see out(), strings by their
+     * growth */
+    template <class Out>
+    class instrument_call {
+    public:
+        explicit instrument_call(Out& out) : out_(out), stream_(&out) {
+            instrument_thread& state = instrument_state();
+            outermost_ = state.nesting == 0;
+            if (outermost_) {
+                if constexpr (std::is_base_of_v<std::ostream, Out>) {
+                    if (out_.rdbuf()) {
+                        stream_ = &local_.emplace(out_);
+                    }
+                } else if constexpr (has_size_member<Out>::value) {
+                    size_ = static_cast<std::size_t>(out_.size());
+                }
+                state.call = print_stats{};
+                if (const auto counter = instrument_config().allocation_counter.load(std::memory_order_relaxed)) {
+                    allocations_ = counter();
+                }
+                start_ = std::chrono::steady_clock::now();
+            }
+            ++state.nesting;
+        }
+
+        ~instrument_call() {
+            instrument_thread& state = instrument_state();
+            --state.nesting;
+            if (!outermost_) {
+                return;
+            }
+            print_stats& call = state.call;
+            if constexpr (std::is_base_of_v<std::ostream, Out>) {
+                if (local_ && !finished_) {
+                    try {
+                        finish();
+                    } catch (...) {
+                        // left by an exception from the print itself, which is the one that propagates
+                    }
+                }
+                if (local_) {
+                    call.bytes = local_->buf().count();
+                }
+            } else if constexpr (has_size_member<Out>::value) {
+                const auto size = static_cast<std::size_t>(out_.size());
+                call.bytes = size - std::min(size_, size);
+            }
+            call.time = std::chrono::steady_clock::now() - start_;
+            if (const auto counter = instrument_config().allocation_counter.load(std::memory_order_relaxed)) {
+                call.allocations = counter() - allocations_;
+            }
+            call.calls = 1;
+            state.total += call;
+            if (const auto callback = instrument_config().callback.load(std::memory_order_relaxed)) {
+                callback(print_record{state.label, call});
+            }
+        }
+
+        instrument_call(const instrument_call&) = delete;
+        instrument_call& operator=(const instrument_call&) = delete;
+
+        /** the stream the call writes to */
+        instrumented_t<Out>& out() const noexcept { return *stream_; }
+
+        /** passes the output on and leaves the caller's stream as the print would have: its width reset and the
+         * state of the call set, which throws if the stream's exception mask asks for it */
+        void finish() {
+            if constexpr (std::is_base_of_v<std::ostream, Out>) {
+                if (!outermost_ || !local_ || finished_) {
+                    return;
+                }
+                finished_ = true;
+                const bool flushed = local_->buf().flush();
+                if (out_.width() != local_->width()) {
+                    out_.width(local_->width());
+                }
+                const auto io_state = local_->rdstate() | (flushed ? std::ios_base::goodbit : std::ios_base::badbit);
+                if ((io_state & ~out_.rdstate()) != 0) {
+                    out_.setstate(io_state);
+                }
+            }
+        }
+
+    private:
+        Out& out_;
+        instrumented_t<Out>* stream_;
+        bool outermost_ = false;
+        bool finished_ = false;
+        std::optional<counting_ostream> local_;
+        std::size_t size_ = 0;
+        std::size_t allocations_ = 0;
+        std::chrono::steady_clock::time_point start_;
+    };
+#else
+    inline void instrument_value(std::size_t) noexcept {}
+    inline void instrument_values(std::size_t, std::size_t) noexcept {}
+
+    class instrument_sizing {};
+
+    template <class Out>
+    using instrumented_t = Out;
+
+    template <class Out>
+    class instrument_call {
+    public:
+        constexpr explicit instrument_call(Out& out) noexcept : out_(out) {}
+
+        constexpr Out& out() const noexcept { return out_; }
+
+        constexpr void finish() const noexcept {}
+
+    private:
+        Out& out_;
+    };
+#endif
+
+}  // namespace pretty::detail
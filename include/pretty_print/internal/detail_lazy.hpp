@@ -0,0 +1,46 @@
+#pragma once
+#include <tuple>        // std::tuple, std::apply
+#include <type_traits>  // std::remove_reference_t
+#include <utility>      // std::forward
+
+#include "detail_pretty_print.hpp"
+
+namespace pretty {
+
+    /** data printed only when the view is written to a stream or a sink, see pretty::lazy
+     * T is a reference for lvalues, which must outlive the view, and a value moved from rvalues */
+    template <class T>
+    class lazy_view {
+    public:
+        explicit lazy_view(T&& data) : data_(std::forward<T>(data)) {}
+
+        const std::remove_reference_t<T>& get() const noexcept { return data_; }
+
+    private:
+        T data_;
+    };
+
+    /** arguments printed like print_args only when the view is written, see pretty::lazy_args */
+    template <class... Args>
+    class lazy_args_view {
+    public:
+        explicit lazy_args_view(Args&&... args) : args_(std::forward<Args>(args)...) {}
+
+        const std::tuple<Args...>& get() const noexcept { return args_; }
+
+    private:
+        std::tuple<Args...> args_;
+    };
+
+    /** inside a print the views are printed at their depth, see print_kind::lazy */
+    template <class Stream, class T>
+    Stream& operator<<(Stream& out, const lazy_view<T>& data) {
+        return detail::ostream::ostream_impl(out, data);
+    }
+
+    template <class Stream, class... Args>
+    Stream& operator<<(Stream& out, const lazy_args_view<Args...>& data) {
+        return detail::ostream::ostream_impl(out, data);
+    }
+
+}  // namespace pretty
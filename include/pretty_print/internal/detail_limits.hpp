@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>      // std::size_t
+#include <iterator>     // std::size
+#include <limits>       // std::numeric_limits
+#include <type_traits>  // std::declval, std::void_t
+
+namespace pretty {
+
+    /** bounds for a single print call, everything past them is replaced by a marker */
+    struct limits {
+        /** elements printed per container, the rest becomes "... (+N more)" */
+        std::size_t max_items = std::numeric_limits<std::size_t>::max();
+        /** containers nested deeper than this print as "[...]" or "{...}" */
+        std::size_t max_depth = std::numeric_limits<std::size_t>::max();
+        /** characters of output, the text is cut there and ends with "..." */
+        std::size_t max_bytes = std::numeric_limits<std::size_t>::max();
+    };
+
+}  // namespace pretty
+
+namespace pretty::detail {
+
+    template <typename Stream, typename = void>
+    struct is_limited_writer : std::false_type {};
+    template <typename Stream>
+    struct is_limited_writer<Stream, std::void_t<decltype(std::declval<const Stream&>().limits())>> : std::true_type {};
+
+    /** writers with limits() stop iterating containers once a limit is reached, see limited_writer */
+    template <typename Stream>
+    inline constexpr bool is_limited_writer_v = is_limited_writer<Stream>::value;
+
+    template <typename T, typename = void>
+    struct has_size : std::false_type {};
+    template <typename T>
+    struct has_size<T, std::void_t<decltype(std::size(std::declval<const T&>()))>> : std::true_type {};
+
+    template <typename T>
+    inline constexpr bool has_size_v = has_size<T>::value;
+
+    /** marker for the elements of data after the first shown ones, the count is taken from size() if any */
+    template <class Stream, class T>
+    void append_more(Stream& out, const T& data, std::size_t shown) {
+        out << "...";
+        if constexpr (has_size_v<T>) {
+            out << " (+" << static_cast<std::size_t>(std::size(data)) - shown << " more)";
+        }
+    }
+
+}  // namespace pretty::detail
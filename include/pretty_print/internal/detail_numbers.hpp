@@ -0,0 +1,200 @@
+#pragma once
+#include <charconv>     // std::to_chars
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint64_t
+#include <cstring>      // std::memcpy
+#include <ios>          // std::ios_base
+#include <iterator>     // std::data, std::size
+#include <locale>       // std::locale
+#include <type_traits>  // std::is_integral_v, std::void_t
+
+namespace pretty::detail {
+
+    /** number of decimal digits in value */
+    constexpr std::size_t count_digits(std::uint64_t value) noexcept {
+        std::size_t n = 1;
+        for (;;) {
+            if (value < 10) return n;
+            if (value < 100) return n + 1;
+            if (value < 1000) return n + 2;
+            if (value < 10000) return n + 3;
+            value /= 10000;
+            n += 4;
+        }
+    }
+
+    /** number of characters std::to_chars produces for an integer */
+    template <class T>
+    constexpr std::size_t integer_size(T value) noexcept {
+        if constexpr (std::is_signed_v<T>) {
+            if (value < 0) {
+                return 1 + count_digits(0 - static_cast<std::uint64_t>(value));
+            }
+        }
+        return count_digits(static_cast<std::uint64_t>(value));
+    }
+
+    /** decimal integer at out, two digits per step from a lookup table
+     * @return pointer past the last written character, at most 20 characters are written */
+    template <class T>
+    char* write_integer(char* out, T value) noexcept {
+        static constexpr char digits[] =
+            "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+            "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+            "8081828384858687888990919293949596979899";
+        std::uint64_t abs = static_cast<std::uint64_t>(value);
+        if constexpr (std::is_signed_v<T>) {
+            if (value < 0) {
+                *out++ = '-';
+                abs = 0 - abs;
+            }
+        }
+        char* const end = out + count_digits(abs);
+        char* it = end;
+        while (abs >= 100) {
+            const auto i = static_cast<std::size_t>(abs % 100) * 2;
+            abs /= 100;
+            *--it = digits[i + 1];
+            *--it = digits[i];
+        }
+        if (abs >= 10) {
+            const auto i = static_cast<std::size_t>(abs) * 2;
+            *--it = digits[i + 1];
+            *--it = digits[i];
+        } else {
+            *--it = static_cast<char>('0' + abs);
+        }
+        return end;
+    }
+
+    template <typename Writer, typename = void>
+    struct is_counting_writer : std::false_type {};
+    template <typename Writer>
+    struct is_counting_writer<Writer, std::void_t<decltype(std::declval<Writer&>().skip(std::size_t{}))>>
+        : std::true_type {};
+
+    /** writers with skip(n) only count characters, so sizes are computed without formatting */
+    template <typename Writer>
+    inline constexpr bool is_counting_writer_v = is_counting_writer<Writer>::value;
+
+    /** numbers a stream prints as digits: arithmetic types except bool and character types */
+    template <typename T>
+    inline constexpr bool is_number_v =
+        std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char> &&
+        !std::is_same_v<T, signed char> && !std::is_same_v<T, unsigned char> && !std::is_same_v<T, wchar_t> &&
+        !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>;
+
+    template <typename T, typename = void>
+    struct is_contiguous_numbers : std::false_type {};
+    template <typename T>
+    struct is_contiguous_numbers<T, std::enable_if_t<std::is_array_v<T>>>
+        : std::bool_constant<std::rank_v<T> == 1 && is_number_v<std::remove_extent_t<T>>> {};
+    template <typename T>
+    struct is_contiguous_numbers<T, std::enable_if_t<!std::is_array_v<T> &&
+                                                     std::is_pointer_v<decltype(std::data(std::declval<const T&>()))>>>
+        : std::bool_constant<is_number_v<std::remove_cv_t<std::remove_pointer_t<decltype(
+              std::data(std::declval<const T&>()))>>>> {};
+
+    /** vector<int>, std::array<float, N>, double[N] and the like */
+    template <typename T>
+    inline constexpr bool is_contiguous_numbers_v = is_contiguous_numbers<T>::value;
+
+    template <typename Stream, typename = void>
+    struct has_write : std::false_type {};
+    template <typename Stream>
+    struct has_write<Stream, std::void_t<decltype(std::declval<Stream&>().write(std::declval<const char*>(), 0))>>
+        : std::true_type {};
+
+    template <typename Stream>
+    inline constexpr bool has_write_v = has_write<Stream>::value;
+
+    template <typename Stream, typename = void>
+    struct has_value_format : std::false_type {};
+    template <typename Stream>
+    struct has_value_format<Stream, std::void_t<decltype(std::declval<const Stream&>().format().has_default_format())>>
+        : std::true_type {};
+
+    /** writers with format() print values in the formatting state of the stream they forward to, see value_format */
+    template <typename Stream>
+    inline constexpr bool has_value_format_v = has_value_format<Stream>::value;
+
+    /** true if numbers printed to out look exactly like std::to_chars output */
+    template <class Stream>
+    bool has_default_number_format(const Stream& out) {
+        if constexpr (std::is_base_of_v<std::ios_base, Stream>) {
+            constexpr auto mask = std::ios_base::basefield | std::ios_base::floatfield | std::ios_base::showpos |
+                                  std::ios_base::showpoint | std::ios_base::uppercase | std::ios_base::showbase;
+            return (out.flags() & mask) == std::ios_base::dec && out.precision() == 6 && out.width() == 0 &&
+                   out.getloc() == std::locale::classic();
+        } else if constexpr (has_value_format_v<Stream>) {
+            return out.format().has_default_format();
+        } else {
+            return true;
+        }
+    }
+
+    /** true if every formatting flag of out is in its default state, so that writers that only know the default
+     * format, e.g. the chunks of parallel_print, write what out would */
+    template <class Stream>
+    bool has_default_format(const Stream& out) {
+        if constexpr (std::is_base_of_v<std::ios_base, Stream>) {
+            return out.flags() == (std::ios_base::skipws | std::ios_base::dec) && has_default_number_format(out);
+        } else if constexpr (has_value_format_v<Stream>) {
+            return out.format().has_default_format();
+        } else {
+            return true;
+        }
+    }
+
+    /** print "[a, b, c]" for a contiguous range of numbers, formatting whole blocks into a local buffer
+     * @return false if out is a stream whose formatting state differs from the default */
+    template <class Stream, class T>
+    bool write_numbers(Stream& out, const T* data, std::size_t size) {
+#if defined(__cpp_lib_to_chars)
+        constexpr bool has_to_chars = true;
+#else
+        constexpr bool has_to_chars = std::is_integral_v<T>;
+#endif
+        if constexpr (!has_write_v<Stream> || !has_to_chars) {
+            return false;
+        } else {
+            if (!has_default_number_format(out)) {
+                return false;
+            }
+            if constexpr (is_counting_writer_v<Stream> && std::is_integral_v<T>) {
+                std::size_t n = size > 0 ? 2 * size : 2;
+                for (std::size_t i = 0; i < size; ++i) {
+                    n += integer_size(data[i]);
+                }
+                out.skip(n);
+            } else {
+                constexpr std::size_t max_size = std::is_integral_v<T> ? 24 : 64;
+                char buf[4096];
+                char* it = buf;
+                *it++ = '[';
+                for (std::size_t i = 0; i < size; ++i) {
+                    if (static_cast<std::size_t>(buf + sizeof(buf) - it) < max_size) {
+                        out.write(buf, it - buf);
+                        it = buf;
+                    }
+                    if (i != 0) {
+                        *it++ = ',';
+                        *it++ = ' ';
+                    }
+                    if constexpr (std::is_integral_v<T>) {
+                        it = write_integer(it, data[i]);
+                    } else {
+                        using float_type = std::conditional_t<std::is_same_v<T, long double>, long double, double>;
+                        it = std::to_chars(it, buf + sizeof(buf), static_cast<float_type>(data[i]),
+                                           std::chars_format::general, 6)
+                                 .ptr;
+                    }
+                }
+                *it++ = ']';
+                out.write(buf, it - buf);
+            }
+            return true;
+        }
+    }
+
+}  // namespace pretty::detail
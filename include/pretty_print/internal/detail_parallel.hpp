@@ -0,0 +1,111 @@
+#pragma once
+#include <algorithm>    // std::min
+#include <atomic>       // std::atomic
+#include <cstddef>      // std::size_t
+#include <exception>    // std::exception_ptr
+#include <iterator>     // std::begin, std::random_access_iterator_tag
+#include <ostream>      // std::ostream
+#include <string>       // std::string
+#include <string_view>  // std::string_view
+#include <thread>       // std::thread
+#include <type_traits>  // std::is_base_of_v
+#include <vector>       // std::vector
+
+#include "detail_writer.hpp"
+
+namespace pretty::detail {
+
+    template <typename T, typename = void>
+    struct is_random_access : std::false_type {};
+    template <typename T>
+    struct is_random_access<T, std::void_t<decltype(std::begin(std::declval<const T&>()))>>
+        : std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<decltype(
+                                                               std::begin(std::declval<const T&>()))>::iterator_category> {
+    };
+
+    template <class Derived>
+    std::true_type is_writer_test(const basic_writer<Derived>*);
+    std::false_type is_writer_test(const void*);
+
+    /** writers derived from basic_writer, including classes derived from a writer */
+    template <typename Stream>
+    inline constexpr bool is_writer_v = decltype(is_writer_test(std::declval<Stream*>()))::value;
+
+    /** ranges whose elements parallel_print formats independently: random access, printed as [a, b, c] */
+    template <typename T>
+    inline constexpr bool is_parallel_range_v =
+        is_random_access<T>::value && is_iterable_v<T> && !is_map_v<T> && !is_c_string_v<T>;
+
+    /** streams whose element text does not depend on the stream type, so chunks can be formatted by writers */
+    template <typename Stream>
+    inline constexpr bool is_parallel_stream_v =
+        (std::is_base_of_v<std::ostream, Stream> || is_writer_v<Stream>) && !is_limited_writer_v<Stream>;
+
+    /** ranges with fewer elements are printed on the calling thread */
+    inline constexpr std::size_t parallel_min_size = 1024;
+
+    /** chunks per thread, more chunks even out elements that take different time to format */
+    inline constexpr std::size_t parallel_chunks_per_thread = 8;
+
+    /** "[a, b, c]" for data, with chunks of elements formatted on threads and written to out in order
+     * the threads are started for the call rather than taken from a pool, and the whole text is kept in chunks
+     * strings until every chunk is done, which pays off only for large ranges, see parallel_min_size;
+     * if a thread can not be started, the threads started so far and the calling one format all chunks */
+    template <class Stream, class T>
+    void parallel_print_impl(Stream& out, const T& data, std::size_t threads) {
+        const auto first = std::begin(data);
+        const auto size = static_cast<std::size_t>(std::end(data) - first);
+        const std::size_t chunk_count = std::min(threads * parallel_chunks_per_thread, size);
+        std::vector<std::string> chunks(chunk_count);
+        std::atomic<std::size_t> next{0};
+        std::atomic<bool> failed{false};
+        std::vector<std::exception_ptr> errors(threads);
+
+        // threads take the next unformatted chunk until none are left, so a slow chunk does not hold the rest
+        auto work = [&](std::size_t thread) {
+            try {
+                for (std::size_t chunk; !failed && (chunk = next++) < chunk_count;) {
+                    const std::size_t begin = size * chunk / chunk_count;
+                    const std::size_t end = size * (chunk + 1) / chunk_count;
+                    string_writer<std::string> writer(chunks[chunk]);
+                    for (std::size_t i = begin; i != end; ++i) {
+                        if (i != 0) {
+                            writer.write(", ", 2);
+                        }
+                        ostream::ostream_impl(writer, quoted_helper(first[i]), 1);
+                    }
+                }
+            } catch (...) {
+                errors[thread] = std::current_exception();
+                failed = true;
+            }
+        };
+
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (std::size_t thread = 1; thread < threads; ++thread) {
+            try {
+                pool.emplace_back(work, thread);
+            } catch (...) {
+                // e.g. std::system_error when the process is out of threads, the started ones take the chunks
+                break;
+            }
+        }
+        work(0);
+        for (auto& thread : pool) {
+            thread.join();
+        }
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        append(out, '[');
+        for (const auto& chunk : chunks) {
+            append(out, std::string_view(chunk));
+        }
+        append(out, ']');
+    }
+
+}  // namespace pretty::detail
@@ -0,0 +1,375 @@
+#pragma once
+#include <algorithm>    // std::count, std::find_if
+#include <array>        // std::array
+#include <charconv>     // std::from_chars
+#include <cstddef>      // std::size_t
+#include <cstdlib>      // std::strtod
+#include <cstring>      // std::memcmp
+#include <stdexcept>    // std::runtime_error
+#include <string>       // std::string, std::to_string
+#include <string_view>  // std::string_view
+#include <tuple>        // std::tuple, std::get
+#include <type_traits>  // std::is_integral_v, std::is_floating_point_v
+#include <utility>      // std::pair, std::move
+
+#include "detail_visit.hpp"
+
+namespace pretty {
+
+    /** text that does not match the type passed to pretty::parse */
+    class parse_error : public std::runtime_error {
+    public:
+        parse_error(const std::string& what, std::size_t position)
+            : std::runtime_error(what + " at position " + std::to_string(position)), position_(position) {}
+
+        /** offset of the first character that could not be parsed */
+        std::size_t position() const noexcept { return position_; }
+
+    private:
+        std::size_t position_;
+    };
+
+}  // namespace pretty
+
+namespace pretty::detail {
+
+    template <typename T, typename = void>
+    struct has_push_back : std::false_type {};
+    template <typename T>
+    struct has_push_back<T, std::void_t<decltype(std::declval<T&>().push_back(std::declval<typename T::value_type>()))>>
+        : std::true_type {};
+
+    template <typename T, typename = void>
+    struct has_reserve : std::false_type {};
+    template <typename T>
+    struct has_reserve<T, std::void_t<decltype(std::declval<T&>().reserve(std::size_t{}))>> : std::true_type {};
+
+    template <typename T>
+    struct is_std_array : std::false_type {};
+    template <typename T, std::size_t N>
+    struct is_std_array<std::array<T, N>> : std::true_type {};
+
+    /** one-pass reader of the pretty::print text, dispatching on the target type like ostream::ostream_impl
+     * whitespace between tokens is skipped, so the multi-line output of print(data, indent) is read too */
+    class parser {
+    public:
+        explicit parser(std::string_view text) noexcept
+            : first_(text.data()), it_(text.data()), last_(text.data() + text.size()) {}
+
+        template <class T>
+        void read(T& data) {
+            constexpr bool has_operator = has_ostream_operator_v<std::ostream, T>;
+            if constexpr (starts_with_char<T>()) {
+                // characters are printed as they are, a space or a tab is one
+                skip_layout();
+            } else {
+                skip_space();
+            }
+            if constexpr (is_pair<T>::value && !has_operator) {
+                read(data.first);
+                expect(':');
+                read(data.second);
+            } else if constexpr (is_tuple<T>::value && !has_operator) {
+                expect('(');
+                read_tuple(data, std::make_index_sequence<std::tuple_size_v<T>>{});
+                expect(')');
+            } else if constexpr (is_optional<T>::value && !has_operator) {
+                if (try_literal("null")) {
+                    data.reset();
+                } else {
+                    read(data.emplace());
+                }
+            } else if constexpr (is_variant<T>::value) {
+                read_variant<0>(data);
+            } else if constexpr (is_iterable_v<T> && !is_c_string_v<T> && (!has_operator || std::is_array_v<T>)) {
+                read_range(data);
+            } else if constexpr (is_std_string<T>::value) {
+                read_string(data);
+            } else if constexpr (std::is_same_v<T, bool>) {
+                if (it_ == last_ || (*it_ != '0' && *it_ != '1')) {
+                    fail("expected 0 or 1");
+                }
+                data = *it_++ == '1';
+            } else if constexpr (is_narrow_char_v<T>) {
+                if (it_ == last_) {
+                    fail("expected a character");
+                }
+                data = static_cast<T>(*it_++);
+            } else if constexpr (std::is_integral_v<T>) {
+                read_number(data);
+            } else if constexpr (std::is_floating_point_v<T>) {
+                read_number(data);
+            } else if constexpr (std::is_enum_v<T> && !has_operator) {
+                std::underlying_type_t<T> value{};
+                read_number(value);
+                data = static_cast<T>(value);
+            } else if constexpr (is_plain_aggregate_v<T> && !has_operator) {
+                auto fields = tie_fields(data);
+                expect('{');
+                read_tuple(fields, std::make_index_sequence<std::tuple_size_v<decltype(fields)>>{});
+                expect('}');
+            } else {
+                static_assert(is_pair<T>::value && has_operator, "type can not be parsed");
+            }
+        }
+
+        /** fail unless only whitespace is left */
+        void finish() {
+            skip_space();
+            if (it_ != last_) {
+                fail("unexpected trailing characters");
+            }
+        }
+
+    private:
+        [[noreturn]] void fail(const char* what) const {
+            throw parse_error(what, static_cast<std::size_t>(it_ - first_));
+        }
+
+        void skip_space() noexcept {
+            while (it_ != last_ && (*it_ == ' ' || *it_ == '\n' || *it_ == '\t' || *it_ == '\r')) {
+                ++it_;
+            }
+        }
+
+        /** the text of T can start with a character printed as it is */
+        template <class T>
+        static constexpr bool starts_with_char() {
+            constexpr bool has_operator = has_ostream_operator_v<std::ostream, T>;
+            if constexpr (is_pair<T>::value && !has_operator) {
+                return starts_with_char<typename T::first_type>();
+            } else if constexpr (is_optional<T>::value && !has_operator) {
+                return starts_with_char<typename T::value_type>();
+            } else if constexpr (is_variant<T>::value) {
+                return starts_with_alternative_char<T>(std::make_index_sequence<std::variant_size_v<T>>{});
+            } else {
+                return is_narrow_char_v<std::remove_cv_t<T>>;
+            }
+        }
+
+        template <class Variant, std::size_t... Is>
+        static constexpr bool starts_with_alternative_char(std::index_sequence<Is...>) {
+            return (starts_with_char<std::variant_alternative_t<Is, Variant>>() || ...);
+        }
+
+        /** the line break and indentation pretty::indent writes before an element; a space printed as
+         * a character at the start of such a line is taken for indentation */
+        void skip_layout() noexcept {
+            if (it_ != last_ && *it_ == '\n') {
+                for (++it_; it_ != last_ && *it_ == ' '; ++it_) {
+                }
+            }
+        }
+
+        /** the separators ',' and ':' take the space print writes after them, so that a character read next
+         * starts after it */
+        bool try_char(char c) noexcept {
+            skip_space();
+            if (it_ != last_ && *it_ == c) {
+                ++it_;
+                if ((c == ',' || c == ':') && it_ != last_ && *it_ == ' ') {
+                    ++it_;
+                }
+                return true;
+            }
+            return false;
+        }
+
+        void expect(char c) {
+            if (!try_char(c)) {
+                const char what[] = {'e', 'x', 'p', 'e', 'c', 't', 'e', 'd', ' ', c, 0};
+                fail(what);
+            }
+        }
+
+        bool try_literal(std::string_view literal) noexcept {
+            if (static_cast<std::size_t>(last_ - it_) >= literal.size() &&
+                std::memcmp(it_, literal.data(), literal.size()) == 0) {
+                it_ += literal.size();
+                return true;
+            }
+            return false;
+        }
+
+        template <class Tuple, std::size_t... Is>
+        void read_tuple(Tuple& data, std::index_sequence<Is...>) {
+            ((Is == 0 ? void() : expect(','), read(std::get<Is>(data))), ...);
+        }
+
+        /** the first alternative whose text can start with the next character, so no alternative is tried twice */
+        template <std::size_t I, class Variant>
+        void read_variant(Variant& data) {
+            if constexpr (I == std::variant_size_v<Variant>) {
+                fail("no variant alternative matches");
+            } else {
+                using alternative = std::variant_alternative_t<I, Variant>;
+                if (it_ != last_ && can_start<alternative>(*it_)) {
+                    read(data.template emplace<I>());
+                } else {
+                    read_variant<I + 1>(data);
+                }
+            }
+        }
+
+        template <class T>
+        static bool can_start(char c) noexcept {
+            constexpr bool has_operator = has_ostream_operator_v<std::ostream, T>;
+            const bool digit = (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'i' || c == 'n';
+            if constexpr (is_pair<T>::value && !has_operator) {
+                return can_start<typename T::first_type>(c);
+            } else if constexpr (is_tuple<T>::value && !has_operator) {
+                return c == '(';
+            } else if constexpr (is_optional<T>::value && !has_operator) {
+                return c == 'n' || can_start<typename T::value_type>(c);
+            } else if constexpr (is_variant<T>::value) {
+                return true;
+            } else if constexpr (is_iterable_v<T> && !is_c_string_v<T> && (!has_operator || std::is_array_v<T>)) {
+                return c == (is_map_v<T> ? '{' : '[');
+            } else if constexpr (is_std_string<T>::value) {
+                return c == '"';
+            } else if constexpr (std::is_same_v<T, bool>) {
+                return c == '0' || c == '1';
+            } else if constexpr (is_narrow_char_v<T>) {
+                return true;
+            } else if constexpr (is_plain_aggregate_v<T> && !has_operator) {
+                return c == '{';
+            } else {
+                return digit;
+            }
+        }
+
+        template <class T>
+        void read_range(T& data) {
+            expect(is_map_v<T> ? '{' : '[');
+            const char close = is_map_v<T> ? '}' : ']';
+            if constexpr (std::is_array_v<T> || is_std_array<T>::value) {
+                std::size_t i = 0;
+                for (auto& el : data) {
+                    if (i++ != 0) {
+                        expect(',');
+                    }
+                    read(el);
+                }
+                expect(close);
+            } else {
+                using value_type = typename T::value_type;
+                data.clear();
+                if constexpr (has_reserve<T>::value && is_number_v<value_type>) {
+                    // numbers contain neither ',' nor ']', so the element count is the comma count up to ']'
+                    const char* end = std::find(it_, last_, close);
+                    data.reserve(static_cast<std::size_t>(std::count(it_, end, ',')) + 1);
+                }
+                if constexpr (starts_with_char<value_type>()) {
+                    // "[ ]" holds a space
+                    skip_layout();
+                    if (it_ != last_ && *it_ == close) {
+                        ++it_;
+                        return;
+                    }
+                } else if (try_char(close)) {
+                    return;
+                }
+                do {
+                    if constexpr (is_map_v<T>) {
+                        std::pair<typename T::key_type, typename T::mapped_type> el;
+                        read(el);
+                        // printed in iteration order, so ordered maps append at the end
+                        data.emplace_hint(data.end(), std::move(el));
+                    } else {
+                        value_type el{};
+                        read(el);
+                        if constexpr (has_push_back<T>::value) {
+                            data.push_back(std::move(el));
+                        } else {
+                            data.insert(data.end(), std::move(el));
+                        }
+                    }
+                } while (try_char(','));
+                expect(close);
+            }
+        }
+
+        template <class String>
+        void read_string(String& data) {
+            expect('"');
+            data.clear();
+            for (;;) {
+                const char* run = std::find_if(it_, last_, [](char c) { return c == '"' || c == '\\'; });
+                data.append(it_, run);
+                it_ = run;
+                if (it_ == last_) {
+                    fail("unterminated string");
+                }
+                if (*it_++ == '"') {
+                    return;
+                }
+                if (it_ == last_) {
+                    fail("unterminated escape");
+                }
+                switch (const char c = *it_++) {
+                    case 'b':
+                        data.push_back('\b');
+                        break;
+                    case 'f':
+                        data.push_back('\f');
+                        break;
+                    case 'n':
+                        data.push_back('\n');
+                        break;
+                    case 'r':
+                        data.push_back('\r');
+                        break;
+                    case 't':
+                        data.push_back('\t');
+                        break;
+                    case 'x': {
+                        unsigned value = 0;
+                        const auto result = std::from_chars(it_, std::min(it_ + 2, last_), value, 16);
+                        if (result.ptr != it_ + 2) {
+                            fail("expected two hex digits");
+                        }
+                        it_ = result.ptr;
+                        data.push_back(static_cast<char>(value));
+                        break;
+                    }
+                    default:
+                        data.push_back(c);
+                }
+            }
+        }
+
+        template <class T>
+        void read_number(T& data) {
+            if constexpr (std::is_integral_v<T>) {
+                const auto result = std::from_chars(it_, last_, data);
+                if (result.ec != std::errc()) {
+                    fail("expected an integer");
+                }
+                it_ = result.ptr;
+            } else {
+#if defined(__cpp_lib_to_chars)
+                const auto result = std::from_chars(it_, last_, data);
+                if (result.ec != std::errc()) {
+                    fail("expected a number");
+                }
+                it_ = result.ptr;
+#else
+                const std::string str(it_, std::find_if(it_, last_, [](char c) { return c == ',' || c == ']' ||
+                                                                                        c == '}' || c == ')' ||
+                                                                                        c == ':' || c == ' '; }));
+                char* end = nullptr;
+                data = static_cast<T>(std::strtod(str.c_str(), &end));
+                if (end == str.c_str()) {
+                    fail("expected a number");
+                }
+                it_ += end - str.c_str();
+#endif
+            }
+        }
+
+        const char* first_;
+        const char* it_;
+        const char* last_;
+    };
+
+}  // namespace pretty::detail
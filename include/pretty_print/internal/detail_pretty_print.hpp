@@ -1,13 +1,26 @@
 #pragma once
 #include <cstddef>      // std::size_t
 #include <iomanip>      // std::quoted
+#include <memory>       // std::addressof
+#include <ostream>      // std::basic_ostream
 #include <string>       // std::string
+#include <string_view>  // std::basic_string_view
 #include <tuple>        // std::tuple
 #include <type_traits>  // std::declval, std::void_t,
                         // std::false_type, std::true_type
 #include <utility>      // std::pair, std::tuple
                         // std::forward
 
+#include "detail_aggregate.hpp"
+#include "detail_escape.hpp"
+#include "detail_graph.hpp"
+#include "detail_indent.hpp"
+#include "detail_instrument.hpp"
+#include "detail_limits.hpp"
+#include "detail_numbers.hpp"
+#include "detail_sorted.hpp"
+#include "detail_utf.hpp"
+
 #if __has_include(<variant>)
 #include <variant>  // std::variant
 #endif
@@ -15,6 +28,15 @@
 #include <optional>  // std::optional
 #endif
 
+namespace pretty {
+
+    template <class T>
+    class lazy_view;
+    template <class... Args>
+    class lazy_args_view;
+
+}  // namespace pretty
+
 namespace pretty::detail {
 
     template <typename T, typename = void>
@@ -47,6 +69,40 @@ namespace pretty::detail {
     inline constexpr bool is_same_any_of_v = is_same_any_of<T, T1, Args...>::value;
 
 
+    template <typename T>
+    struct is_pair : std::false_type {};
+    template <typename T, typename V>
+    struct is_pair<std::pair<T, V>> : std::true_type {};
+
+    template <typename T>
+    struct is_tuple : std::false_type {};
+    template <typename... Args>
+    struct is_tuple<std::tuple<Args...>> : std::true_type {};
+
+    template <typename T>
+    struct is_optional : std::false_type {};
+#if __has_include(<optional>)
+    template <typename T>
+    struct is_optional<std::optional<T>> : std::true_type {};
+#endif
+
+    template <typename T>
+    struct is_variant : std::false_type {};
+#if __has_include(<variant>)
+    template <typename... Ts>
+    struct is_variant<std::variant<Ts...>> : std::true_type {};
+#endif
+
+    template <typename T>
+    struct is_lazy_args : std::false_type {};
+    template <typename... Args>
+    struct is_lazy_args<pretty::lazy_args_view<Args...>> : std::true_type {};
+
+    template <typename T>
+    struct is_lazy : is_lazy_args<T> {};
+    template <typename T>
+    struct is_lazy<pretty::lazy_view<T>> : std::true_type {};
+
     template <typename T>
     inline constexpr bool is_char_type_v =
         is_same_any_of_v<T, unsigned char, signed char, char, char16_t, char32_t, wchar_t>;
@@ -70,20 +126,68 @@ namespace pretty::detail {
     template <typename T>
     inline constexpr bool is_map_v = is_map<T>::value;
 
+    /** string wrapper printed in quotes with escaped delimiters, like std::quoted */
+    template <class CharT, class Traits = std::char_traits<CharT>>
+    struct quoted_view {
+        std::basic_string_view<CharT, Traits> str;
+    };
+
+    /** narrow strings go through the vectorized escaping kernel, see write_quoted */
+    inline std::ostream& operator<<(std::ostream& out, quoted_view<char> data) {
+        if (out.width() != 0) {
+            std::string str;
+            str.reserve(data.str.size() + 2);
+            struct {
+                std::string& str;
+                void write(const char* s, std::size_t n) { str.append(s, n); }
+                void put(char c) { str.push_back(c); }
+            } writer{str};
+            write_quoted(writer, data.str);
+            return out << str;
+        }
+        ostream_buffer buffer(out);
+        write_quoted(buffer, data.str);
+        return out;
+    }
+
+    /** UTF-16 and UTF-32 strings are transcoded to UTF-8 and escaped like narrow ones, see write_quoted_utf */
+    template <class CharT, class Traits, typename = std::enable_if_t<is_wide_char_v<CharT>>>
+    std::ostream& operator<<(std::ostream& out, quoted_view<CharT, Traits> data) {
+        if (out.width() != 0) {
+            std::string str;
+            struct {
+                std::string& str;
+                void write(const char* s, std::size_t n) { str.append(s, n); }
+                void put(char c) { str.push_back(c); }
+            } writer{str};
+            write_quoted_utf(writer, data.str);
+            return out << str;
+        }
+        ostream_buffer buffer(out);
+        write_quoted_utf(buffer, data.str);
+        return out;
+    }
+
+    template <class CharT, class Traits>
+    std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& out,
+                                                  quoted_view<CharT, Traits> data) {
+        return out << std::quoted(data.str);
+    }
+
     template <typename T, std::size_t N, typename = std::enable_if_t<is_char_type_v<T>>>
     auto quoted_helper(const T (&s)[N]) noexcept {
-        return std::quoted(s);
+        return quoted_view<T>{s};
     }
 
-    inline auto quoted_helper(const char* c) noexcept { return std::quoted(c); }
+    inline auto quoted_helper(const char* c) noexcept { return quoted_view<char>{c}; }
 
-    inline auto quoted_helper(const std::string& s) noexcept { return std::quoted(s); }
+    inline auto quoted_helper(const std::string& s) noexcept { return quoted_view<char>{s}; }
 
-    inline auto quoted_helper(std::string& s) noexcept { return std::quoted(s); }
+    inline auto quoted_helper(std::string& s) noexcept { return quoted_view<char>{s}; }
 
     template <class CharT, class Traits>
     auto quoted_helper(std::basic_string_view<CharT, Traits> s) noexcept {
-        return std::quoted(s);
+        return quoted_view<CharT, Traits>{s};
     }
 
     template <class T>
@@ -91,23 +195,97 @@ namespace pretty::detail {
         return std::forward<T>(v);
     }
 
+    /** quoted_view of a string, array or pointer of UTF-16 or UTF-32 code units */
+    template <class T>
+    auto quoted_wide(const T& s) noexcept {
+        using char_type = typename is_wide_string<T>::char_type;
+        return quoted_view<char_type>{std::basic_string_view<char_type>(s)};
+    }
+
+    /** wide strings that Stream prints quoted, as UTF-8 on narrow streams; others stay code unit arrays */
+    template <class Stream, class T>
+    constexpr bool is_quoted_wide_string() {
+        if constexpr (is_wide_string_v<T>) {
+            return has_ostream_operator_v<Stream, decltype(quoted_wide(std::declval<const T&>()))>;
+        } else {
+            return false;
+        }
+    }
+
+    /** iterables that Stream prints element by element in brackets, not through an operator<< of their own */
+    template <class Stream, class T>
+    constexpr bool is_printed_as_container() {
+        return is_iterable_v<T> && !is_c_string_v<T> && !is_quoted_wide_string<Stream, T>() &&
+               (!has_ostream_operator_v<Stream, T> || std::is_array_v<T>);
+    }
+
+    /** how ostream::ostream_impl prints T to Stream: pair, tuple, optional and variant through overloads of their
+     * own, the rest through the generic one; traverse walks values with the same dispatch
+     * lazy views print their data at the depth of the view rather than through their operator<< */
+    enum class print_kind {
+        lazy,
+        pair,
+        tuple,
+        optional,
+        variant,
+        pointer,
+        container,
+        wide_string,
+        text,
+        enumeration,
+        aggregate,
+        unsupported
+    };
+
+    template <class Stream, class T>
+    constexpr print_kind print_kind_of() {
+        constexpr bool has_operator = has_ostream_operator_v<Stream, T>;
+        if constexpr (is_lazy<T>::value) {
+            return print_kind::lazy;
+        } else if constexpr (is_pair<T>::value && !has_operator) {
+            return print_kind::pair;
+        } else if constexpr (is_tuple<T>::value && !has_operator) {
+            return print_kind::tuple;
+        } else if constexpr (is_optional<T>::value && !has_operator) {
+            return print_kind::optional;
+        } else if constexpr (is_variant<T>::value) {
+            return print_kind::variant;
+        } else if constexpr (is_graph_writer_v<Stream> && is_object_pointer_v<T>) {
+            return print_kind::pointer;
+        } else if constexpr (is_printed_as_container<Stream, T>()) {
+            return print_kind::container;
+        } else if constexpr (is_quoted_wide_string<Stream, T>()) {
+            return print_kind::wide_string;
+        } else if constexpr (has_operator) {
+            return print_kind::text;
+        } else if constexpr (std::is_enum_v<T>) {
+            return print_kind::enumeration;
+        } else if constexpr (is_plain_aggregate_v<T>) {
+            return print_kind::aggregate;
+        } else {
+            return print_kind::unsupported;
+        }
+    }
+
+    /** depth is the number of enclosing containers, a runtime argument so that every element type is
+     * instantiated once whatever the nesting; only the indent and limited writers read it */
     struct ostream {  // struct ostream
-        template <std::size_t Nested, class Stream, class T>
-        static Stream& ostream_impl(Stream& out, const T& data);
-        template <std::size_t Nested, class Stream, typename T, typename V,
+        template <class Stream, class T>
+        static Stream& ostream_impl(Stream& out, const T& data, std::size_t depth = 0);
+        template <class Stream, typename T, typename V,
                   typename = std::enable_if_t<!detail::has_ostream_operator_v<Stream, std::pair<T, V>>>>
-        static Stream& ostream_impl(Stream& out, const std::pair<T, V>& data);
-        template <std::size_t Nested, class Stream, typename... Args,
+        static Stream& ostream_impl(Stream& out, const std::pair<T, V>& data, std::size_t depth = 0);
+        template <class Stream, typename... Args,
                   typename = std::enable_if_t<!detail::has_ostream_operator_v<Stream, std::tuple<Args...>>>>
-        static Stream& ostream_impl(Stream& out, const std::tuple<Args...>& data);
+        static Stream& ostream_impl(Stream& out, const std::tuple<Args...>& data, std::size_t depth = 0);
 #if __has_include(<optional>)
-        template <std::size_t Nested, class Stream, typename T,
+        template <class Stream, typename T,
                   typename = std::enable_if_t<!detail::has_ostream_operator_v<Stream, std::optional<T>>>>
-        static Stream& ostream_impl(Stream& out, const std::optional<T>& data);
+        static Stream& ostream_impl(Stream& out, const std::optional<T>& data, std::size_t depth = 0);
 #endif
 #if __has_include(<variant>)
-        template <std::size_t Nested, class Stream, typename T, typename... Ts>
-        static Stream& ostream_impl(Stream& out, const std::variant<T, Ts...>& data);
+        template <class Stream, typename T, typename... Ts>
+        static Stream& ostream_impl(Stream& out, const std::variant<T, Ts...>& data, std::size_t depth = 0);
 #endif
     };  // struct ostream
 
@@ -116,26 +294,116 @@ namespace pretty::detail {
         out << std::forward<T>(data);
     }
 
-    template <std::size_t Nested, class Stream, class Tuple, std::size_t... Is>
-    void print_tuple_impl(Stream& out, const Tuple& value, std::index_sequence<Is...>) {
-        ((void)(append(out, (Is == 0 ? "" : ", ")), (void)ostream::ostream_impl<Nested>(out, std::get<Is>(value))),
+    template <class Stream, class Tuple, std::size_t... Is>
+    void print_tuple_impl(Stream& out, const Tuple& value, [[maybe_unused]] std::size_t depth,
+                          std::index_sequence<Is...>) {
+        ((void)(append(out, (Is == 0 ? "" : ", ")), (void)ostream::ostream_impl(out, std::get<Is>(value), depth)),
          ...);
     }
 
-    template <std::size_t Nested, class Stream, class T>
-    Stream& ostream::ostream_impl(Stream& out, const T& data) {
-        if constexpr (detail::is_iterable_v<T> && !detail::is_c_string_v<T> &&
-                      ((!detail::has_ostream_operator_v<Stream, T>) || std::is_array_v<T>)) {
-            std::string delimiter;
+    template <class Stream, class T>
+    Stream& ostream::ostream_impl(Stream& out, const T& data, std::size_t depth) {
+        detail::instrument_value(depth);
+        constexpr detail::print_kind kind = detail::print_kind_of<Stream, T>();
+        if constexpr (kind == detail::print_kind::lazy) {
+            if constexpr (is_lazy_args<T>::value) {
+                std::apply(
+                    [&out, depth](const auto&... args) {
+                        (((void)ostream_impl(out, args, depth), append(out, ' ')), ...);
+                    },
+                    data.get());
+            } else {
+                ostream_impl(out, data.get(), depth);
+            }
+        } else if constexpr (kind == detail::print_kind::pointer) {
+            if constexpr (detail::is_weak_ptr<T>::value) {
+                return ostream_impl(out, data.lock(), depth);
+            } else {
+                if (!data) {
+                    append(out, "null");
+                    return out;
+                }
+                using pointee = std::remove_cv_t<typename detail::pointee_of<T>::type>;
+                const auto [id, added] = out.visited().insert(std::addressof(*data), &detail::type_tag<pointee>);
+                if (!added) {
+                    append(out, "<ref #");
+                    append(out, id);
+                    append(out, '>');
+                    return out;
+                }
+                append(out, '#');
+                append(out, id);
+                append(out, ' ');
+                return ostream_impl(out, detail::quoted_helper(*data), depth);
+            }
+        } else if constexpr (kind == detail::print_kind::container) {
+            if constexpr (detail::is_sorted_writer_v<Stream> && detail::is_sortable_unordered_v<T>) {
+                const detail::sorted_elements<T> sorted(data);
+                append(out, is_map_v<T> ? '{' : '[');
+                std::string_view delimiter;
+                sorted.for_each([&](const auto& el) {
+                    append(out, delimiter);
+                    ostream_impl(out, detail::quoted_helper(el), depth + 1);
+                    delimiter = ", ";
+                });
+                append(out, is_map_v<T> ? '}' : ']');
+                return out;
+            }
+            if constexpr (detail::is_indent_writer_v<Stream>) {
+                if (out.multiline() && std::begin(data) != std::end(data)) {
+                    if (out.fits(data)) {
+                        out.multiline(false);
+                        ostream_impl(out, data, depth);
+                        out.multiline(true);
+                        return out;
+                    }
+                    append(out, is_map_v<T> ? '{' : '[');
+                    std::string_view delimiter;
+                    for (const auto& el : data) {
+                        append(out, delimiter);
+                        out.newline(depth + 1);
+                        ostream_impl(out, detail::quoted_helper(el), depth + 1);
+                        delimiter = ",";
+                    }
+                    out.newline(depth);
+                    append(out, is_map_v<T> ? '}' : ']');
+                    return out;
+                }
+            }
+            if constexpr (detail::is_limited_writer_v<Stream>) {
+                if (depth >= out.limits().max_depth && std::begin(data) != std::end(data)) {
+                    append(out, is_map_v<T> ? "{...}" : "[...]");
+                    return out;
+                }
+            } else if constexpr (detail::is_contiguous_numbers_v<T>) {
+                if (detail::write_numbers(out, std::data(data), std::size(data))) {
+                    detail::instrument_values(std::size(data), depth + 1);
+                    return out;
+                }
+            }
+
+            std::string_view delimiter;
             if constexpr (is_map_v<T>) {
                 append(out, '{');
             } else {
                 append(out, '[');
             }
 
+            [[maybe_unused]] std::size_t shown = 0;
             for (const auto& el : data) {
+                if constexpr (detail::is_limited_writer_v<Stream>) {
+                    if (out.exhausted()) {
+                        return out;
+                    }
+                    if (shown == out.limits().max_items) {
+                        append(out, delimiter);
+                        detail::append_more(out, data, shown);
+                        break;
+                    }
+                    ++shown;
+                }
                 append(out, delimiter);
-                ostream_impl<Nested + 1>(out, detail::quoted_helper(el));
+                ostream_impl(out, detail::quoted_helper(el), depth + 1);
                 delimiter = ", ";
             }
 
@@ -144,45 +412,52 @@ namespace pretty::detail {
             } else {
                 append(out, ']');
             }
-        } else if constexpr (detail::has_ostream_operator_v<Stream, T>) {
+        } else if constexpr (kind == detail::print_kind::wide_string) {
+            append(out, detail::quoted_wide(data));
+        } else if constexpr (kind == detail::print_kind::text) {
             append(out, detail::quoted_helper(data));
-        } else if constexpr (std::is_enum_v<T>) {
+        } else if constexpr (kind == detail::print_kind::enumeration) {
             append(out, static_cast<std::underlying_type_t<T>>(data));
+        } else if constexpr (kind == detail::print_kind::aggregate) {
+            const auto fields = detail::tie_fields(data);
+            append(out, '{');
+            detail::print_tuple_impl(out, fields, depth, std::make_index_sequence<std::tuple_size_v<decltype(fields)>>{});
+            append(out, '}');
         } else {
-            static_assert(detail::has_ostream_operator_v<Stream, T> && !std::is_enum_v<T>,
+            static_assert(kind != detail::print_kind::unsupported,
                           "not support [ostream& operator<<(ostream& out, const T& data)]");
         }
 
         return out;
     }
 
-    template <std::size_t Nested, class Stream, typename T, typename V, typename>
-    Stream& ostream::ostream_impl(Stream& out, const std::pair<T, V>& data) {
+    template <class Stream, typename T, typename V, typename>
+    Stream& ostream::ostream_impl(Stream& out, const std::pair<T, V>& data, std::size_t depth) {
         if constexpr (detail::has_ostream_operator_v<Stream, std::pair<T, V>>) {
             append(out, data);
         } else {
-            ///*if (!!Nested) */ out << '{';
-            ostream_impl<Nested + 1>(out, detail::quoted_helper(data.first));
+            ///*if (depth) */ out << '{';
+            ostream_impl(out, detail::quoted_helper(data.first), depth);
             append(out, ": ");
-            ostream_impl<Nested + 1>(out, detail::quoted_helper(data.second));
-            ///*if (!!Nested)*/ out << '}';
+            ostream_impl(out, detail::quoted_helper(data.second), depth);
+            ///*if (depth)*/ out << '}';
         }
         return out;
     }
 
-    template <std::size_t Nested, class Stream, typename... Args, typename>
-    Stream& ostream::ostream_impl(Stream& out, const std::tuple<Args...>& data) {
+    template <class Stream, typename... Args, typename>
+    Stream& ostream::ostream_impl(Stream& out, const std::tuple<Args...>& data, std::size_t depth) {
         append(out, "(");
-        detail::print_tuple_impl<Nested>(out, data, std::index_sequence_for<Args...>{});
+        detail::print_tuple_impl(out, data, depth, std::index_sequence_for<Args...>{});
         append(out, ")");
         return out;
     }
 
 #if __has_include(<optional>)
-    template <std::size_t Nested, class Stream, typename T, typename>
-    Stream& ostream::ostream_impl(Stream& out, const std::optional<T>& data) {
+    template <class Stream, typename T, typename>
+    Stream& ostream::ostream_impl(Stream& out, const std::optional<T>& data, std::size_t depth) {
         if (data) {
-            ostream_impl<Nested>(out, detail::quoted_helper(data.value()));
+            ostream_impl(out, detail::quoted_helper(data.value()), depth);
         } else {
             append(out, "null");
         }
@@ -191,10 +466,10 @@ namespace pretty::detail {
 #endif
 
 #if __has_include(<variant>)
-    template <std::size_t Nested, class Stream, typename T, typename... Ts>
-    Stream& ostream::ostream_impl(Stream& out, const std::variant<T, Ts...>& data) {
+    template <class Stream, typename T, typename... Ts>
+    Stream& ostream::ostream_impl(Stream& out, const std::variant<T, Ts...>& data, std::size_t depth) {
         if (data.index() != std::variant_npos) {
-            std::visit([&out](const auto& t) { ostream_impl<Nested>(out, t); }, data);
+            std::visit([&out, depth](const auto& t) { ostream_impl(out, t, depth); }, data);
             return out;
         }
         append(out, "VARIANT_NPOS");
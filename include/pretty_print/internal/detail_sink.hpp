@@ -0,0 +1,123 @@
+#pragma once
+#include <algorithm>  // std::max
+#include <cerrno>     // errno, EINTR
+#include <cstddef>    // std::size_t
+#include <cstdio>     // std::FILE, std::fflush
+#include <cstring>    // std::memcpy
+#include <memory>     // std::unique_ptr
+
+#if __has_include(<sys/uio.h>) && __has_include(<unistd.h>)
+#define PRETTY_PRINT_HAS_WRITEV 1
+#include <sys/uio.h>  // ::writev
+#include <unistd.h>   // ::write
+#else
+#include <io.h>  // ::_write
+#endif
+
+#include "detail_writer.hpp"
+
+namespace pretty {
+
+    /** buffered output to a file descriptor, accepted by print, print_line and print_args like a stream
+     * bytes are collected in a fixed-size buffer and written when it is full, on flush() and on destruction,
+     * payloads of at least half the buffer go to the descriptor directly, batched with the buffer by writev */
+    class fd_sink : public detail::basic_writer<fd_sink> {
+    public:
+        static constexpr std::size_t default_buffer_size = 64 * 1024;
+
+        explicit fd_sink(int fd, std::size_t buffer_size = default_buffer_size)
+            : fd_(fd), capacity_(std::max(buffer_size, std::size_t{1})), buffer_(new char[capacity_]) {}
+        ~fd_sink() { flush(); }
+
+        fd_sink(const fd_sink&) = delete;
+        fd_sink& operator=(const fd_sink&) = delete;
+
+        void write(const char* s, std::size_t n) {
+            if (n == 0) {
+                return;
+            }
+            if (n <= capacity_ - size_) {
+                std::memcpy(buffer_.get() + size_, s, n);
+                size_ += n;
+            } else if (n >= capacity_ / 2) {
+                write_all(buffer_.get(), size_, s, n);
+                size_ = 0;
+            } else {
+                flush();
+                std::memcpy(buffer_.get(), s, n);
+                size_ = n;
+            }
+        }
+        void put(char c) {
+            if (size_ == capacity_) {
+                flush();
+            }
+            buffer_[size_++] = c;
+        }
+
+        /** write out the buffered bytes
+         * @return false if any write to the descriptor has failed */
+        bool flush() {
+            write_all(buffer_.get(), size_, nullptr, 0);
+            size_ = 0;
+            return good_;
+        }
+
+        /** false if any write to the descriptor has failed, the bytes of a failed write are dropped */
+        bool good() const noexcept { return good_; }
+
+    private:
+        void write_all(const char* head, std::size_t head_size, const char* tail, std::size_t tail_size) {
+            while (good_ && head_size + tail_size > 0) {
+#if defined(PRETTY_PRINT_HAS_WRITEV)
+                iovec iov[2] = {{const_cast<char*>(head), head_size}, {const_cast<char*>(tail), tail_size}};
+                const ssize_t result = head_size > 0 ? ::writev(fd_, iov, tail_size > 0 ? 2 : 1)
+                                                     : ::write(fd_, tail, tail_size);
+#else
+                const int result = head_size > 0 ? ::_write(fd_, head, static_cast<unsigned>(head_size))
+                                                 : ::_write(fd_, tail, static_cast<unsigned>(tail_size));
+#endif
+                if (result < 0) {
+                    if (errno != EINTR) {
+                        good_ = false;
+                    }
+                    continue;
+                }
+                auto written = static_cast<std::size_t>(result);
+                if (written >= head_size) {
+                    written -= head_size;
+                    head_size = 0;
+                    tail += written;
+                    tail_size -= written;
+                } else {
+                    head += written;
+                    head_size -= written;
+                }
+            }
+        }
+
+        int fd_;
+        std::size_t capacity_;
+        std::unique_ptr<char[]> buffer_;
+        std::size_t size_ = 0;
+        bool good_ = true;
+    };
+
+    /** fd_sink on the descriptor of a FILE*, pending stdio output of the file is flushed first */
+    class file_sink : public fd_sink {
+    public:
+        explicit file_sink(std::FILE* file, std::size_t buffer_size = default_buffer_size)
+            : fd_sink(descriptor(file), buffer_size) {}
+
+    private:
+        static int descriptor(std::FILE* file) {
+            std::fflush(file);
+#if defined(PRETTY_PRINT_HAS_WRITEV)
+            return ::fileno(file);
+#else
+            return ::_fileno(file);
+#endif
+        }
+    };
+
+}  // namespace pretty
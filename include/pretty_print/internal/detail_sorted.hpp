@@ -0,0 +1,118 @@
+#pragma once
+#include <algorithm>    // std::sort
+#include <cstddef>      // std::size_t
+#include <functional>   // std::less
+#include <iterator>     // std::size
+#include <memory>       // std::unique_ptr
+#include <type_traits>  // std::declval, std::void_t
+
+namespace pretty {
+
+    /** unordered containers printed in key order instead of hash order, so the text does not depend
+     * on the hash function, the bucket count or the insertion history */
+    struct sorted_unordered {};
+
+}  // namespace pretty
+
+namespace pretty::detail {
+
+    template <typename Stream, typename = void>
+    struct is_sorted_writer : std::false_type {};
+    template <typename Stream>
+    struct is_sorted_writer<Stream, std::void_t<decltype(std::declval<const Stream&>().sorts_unordered())>>
+        : std::true_type {};
+
+    /** writers with sorts_unordered() print unordered containers in key order, see sorted_writer */
+    template <typename Stream>
+    inline constexpr bool is_sorted_writer_v = is_sorted_writer<Stream>::value;
+
+    template <typename T, typename = void>
+    struct is_mapped : std::false_type {};
+    template <typename T>
+    struct is_mapped<T, std::void_t<typename T::mapped_type>> : std::true_type {};
+
+    /** the key of a map entry or set element */
+    template <class T>
+    const auto& sort_key(const typename T::value_type& el) noexcept {
+        if constexpr (is_mapped<T>::value) {
+            return el.first;
+        } else {
+            return el;
+        }
+    }
+
+    template <typename T, typename = void>
+    struct has_less : std::false_type {};
+    template <typename T>
+    struct has_less<T, std::void_t<decltype(std::declval<const T&>() < std::declval<const T&>())>> : std::true_type {};
+
+    template <typename T, typename = void>
+    struct is_sortable_unordered : std::false_type {};
+    template <typename T>
+    struct is_sortable_unordered<T, std::void_t<typename T::key_type, typename T::hasher>>
+        : has_less<typename T::key_type> {};
+
+    /** unordered_map, unordered_set and their multi versions whose keys have operator<;
+     * others keep their iteration order */
+    template <typename T>
+    inline constexpr bool is_sortable_unordered_v = is_sortable_unordered<T>::value;
+
+    template <typename T, typename = void>
+    struct has_unique_keys : std::false_type {};
+    template <typename T>
+    struct has_unique_keys<T, std::void_t<decltype(std::declval<T&>().insert(std::declval<typename T::value_type>())
+                                                        .second)>> : std::true_type {};
+
+    /** the elements of an unordered container in key order, one iterator of memory per element
+     * small containers sort on the stack; equal keys of multi containers are adjacent in iteration order,
+     * so only the first of each run is sorted and the run is printed in its iteration order */
+    template <class T>
+    class sorted_elements {
+    public:
+        using iterator = typename T::const_iterator;
+
+        explicit sorted_elements(const T& data) : data_(data), size_(0) {
+            const auto count = static_cast<std::size_t>(std::size(data));
+            if (count > stack_size) {
+                heap_.reset(new iterator[count]);
+            }
+            iterator* heads = begin();
+            for (auto it = data.begin(); it != data.end(); ++it) {
+                if (has_unique_keys<T>::value || size_ == 0 || !same_key(heads[size_ - 1], it)) {
+                    heads[size_++] = it;
+                }
+            }
+            std::sort(heads, heads + size_, [](const iterator& a, const iterator& b) {
+                return std::less<typename T::key_type>{}(sort_key<T>(*a), sort_key<T>(*b));
+            });
+        }
+
+        /** fn(element) for every element in key order */
+        template <class F>
+        void for_each(F&& fn) const {
+            const iterator* heads = heap_ ? heap_.get() : stack_;
+            for (std::size_t i = 0; i != size_; ++i) {
+                iterator it = heads[i];
+                do {
+                    fn(*it);
+                    ++it;
+                } while (!has_unique_keys<T>::value && it != data_.end() && same_key(heads[i], it));
+            }
+        }
+
+    private:
+        static constexpr std::size_t stack_size = 64;
+
+        iterator* begin() noexcept { return heap_ ? heap_.get() : stack_; }
+
+        bool same_key(const iterator& a, const iterator& b) const {
+            return data_.key_eq()(sort_key<T>(*a), sort_key<T>(*b));
+        }
+
+        const T& data_;
+        std::size_t size_;
+        iterator stack_[stack_size];
+        std::unique_ptr<iterator[]> heap_;
+    };
+
+}  // namespace pretty::detail
@@ -0,0 +1,190 @@
+#pragma once
+#include <array>        // std::array
+#include <cstddef>      // std::size_t
+#include <ostream>      // std::ostream
+#include <string_view>  // std::string_view
+#include <tuple>        // std::tuple_size_v, std::get
+#include <type_traits>  // std::is_integral_v, std::is_enum_v, std::void_t
+#include <utility>      // std::index_sequence
+
+#include "detail_visit.hpp"
+
+namespace pretty {
+
+    /** null-terminated text of N characters, the result of pretty::static_print */
+    template <std::size_t N>
+    class fixed_string {
+    public:
+        static constexpr std::size_t size() noexcept { return N; }
+        constexpr const char* data() const noexcept { return data_; }
+        constexpr char* data() noexcept { return data_; }
+        constexpr const char* c_str() const noexcept { return data_; }
+        constexpr std::string_view view() const noexcept { return {data_, N}; }
+        constexpr operator std::string_view() const noexcept { return view(); }
+        constexpr char operator[](std::size_t i) const noexcept { return data_[i]; }
+
+    private:
+        char data_[N + 1] = {};
+    };
+
+    template <std::size_t N>
+    std::ostream& operator<<(std::ostream& out, const fixed_string<N>& str) {
+        return out.write(str.data(), static_cast<std::streamsize>(N));
+    }
+
+}  // namespace pretty
+
+namespace pretty::detail {
+
+    /** writer usable in constant expressions, it only counts the characters when out is nullptr */
+    struct static_writer {
+        char* out = nullptr;
+        std::size_t size = 0;
+
+        constexpr void put(char c) noexcept {
+            if (out) {
+                out[size] = c;
+            }
+            ++size;
+        }
+        constexpr void write(std::string_view str) noexcept {
+            for (const char c : str) {
+                put(c);
+            }
+        }
+    };
+
+    template <class T>
+    inline constexpr bool is_std_array_v = false;
+    template <class T, std::size_t N>
+    inline constexpr bool is_std_array_v<std::array<T, N>> = true;
+
+    /** converts to std::ostream& and nothing else: probe << value finds an operator<<(std::ostream&, T) of T,
+     * but not the members of std::ostream an unscoped enum reaches through its promotion to int */
+    struct ostream_probe {
+        operator std::ostream&() const;
+    };
+
+    template <class T, typename = void>
+    struct has_own_ostream_operator : std::false_type {};
+    template <class T>
+    struct has_own_ostream_operator<
+        T, std::void_t<decltype(std::declval<ostream_probe&>() << std::declval<const T&>())>> : std::true_type {};
+
+    /** write_quoted in a constant expression */
+    constexpr void static_write_quoted(static_writer& out, std::string_view str) noexcept {
+        out.put('"');
+        const char* const last = str.data() + str.size();
+        for (const char* it = str.data(); it != last; ++it) {
+            const auto c = static_cast<unsigned char>(*it);
+            if (!is_escape_candidate(c)) {
+                out.put(*it);
+                continue;
+            }
+            if (c >= 0x80) {
+                if (const std::size_t n = utf8_sequence_size(it, last)) {
+                    out.write(std::string_view(it, n));
+                    it += n - 1;
+                    continue;
+                }
+            }
+            char escaped[4] = {};
+            out.write(std::string_view(escaped, static_cast<std::size_t>(escape_byte(c, escaped) - escaped)));
+        }
+        out.put('"');
+    }
+
+    template <class T>
+    constexpr void static_write_integer(static_writer& out, T value) noexcept {
+        using unsigned_type = std::make_unsigned_t<T>;
+        auto magnitude = static_cast<unsigned_type>(value);
+        if constexpr (std::is_signed_v<T>) {
+            if (value < 0) {
+                out.put('-');
+                magnitude = static_cast<unsigned_type>(unsigned_type{0} - magnitude);
+            }
+        }
+        char digits[20] = {};
+        std::size_t n = 0;
+        do {
+            digits[n++] = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+        while (n != 0) {
+            out.put(digits[--n]);
+        }
+    }
+
+    template <class T>
+    constexpr void static_write(static_writer& out, const T& data);
+
+    template <class Tuple, std::size_t... Is>
+    constexpr void static_write_tuple(static_writer& out, const Tuple& data, std::index_sequence<Is...>) {
+        ((out.write(Is == 0 ? "" : ", "), static_write(out, std::get<Is>(data))), ...);
+    }
+
+    /** the text of pretty::print for data known at compile time:
+     * integers, bool, characters, enums, strings, C arrays, std::array, pairs, tuples and aggregates of them */
+    template <class T>
+    constexpr void static_write(static_writer& out, const T& data) {
+        constexpr bool has_operator = has_ostream_operator_v<std::ostream, T>;
+        if constexpr (is_pair<T>::value) {
+            static_write(out, data.first);
+            out.write(": ");
+            static_write(out, data.second);
+        } else if constexpr (is_tuple<T>::value) {
+            out.put('(');
+            static_write_tuple(out, data, std::make_index_sequence<std::tuple_size_v<T>>{});
+            out.put(')');
+        } else if constexpr (std::is_array_v<T> && is_narrow_char_v<std::remove_extent_t<T>>) {
+            static_write_quoted(out, std::string_view(data));
+        } else if constexpr (is_same_any_of_v<T, const char*, char*, std::string_view>) {
+            static_write_quoted(out, std::string_view(data));
+        } else if constexpr (std::is_array_v<T> || is_std_array_v<T>) {
+            out.put('[');
+            std::size_t i = 0;
+            for (const auto& el : data) {
+                out.write(i++ == 0 ? "" : ", ");
+                static_write(out, el);
+            }
+            out.put(']');
+        } else if constexpr (std::is_same_v<T, bool>) {
+            out.put(data ? '1' : '0');
+        } else if constexpr (is_narrow_char_v<T>) {
+            out.put(static_cast<char>(data));
+        } else if constexpr (std::is_integral_v<T>) {
+            static_write_integer(out, data);
+        } else if constexpr (std::is_enum_v<T> && !has_own_ostream_operator<T>::value) {
+            // print writes these through the promotion to int or as their underlying value, an operator<< of
+            // their own can not run at compile time
+            static_write_integer(out, static_cast<std::underlying_type_t<T>>(data));
+        } else if constexpr (is_plain_aggregate_v<T> && !has_operator) {
+            const auto fields = tie_fields(data);
+            out.put('{');
+            static_write_tuple(out, fields, std::make_index_sequence<std::tuple_size_v<decltype(fields)>>{});
+            out.put('}');
+        } else {
+            static_assert(is_pair<T>::value && has_operator, "type can not be printed at compile time");
+        }
+    }
+
+    template <const auto& Value>
+    constexpr std::size_t static_size() {
+        static_writer out;
+        static_write(out, Value);
+        return out.size;
+    }
+
+    template <const auto& Value>
+    constexpr auto static_format() {
+        fixed_string<static_size<Value>()> result;
+        static_writer out{result.data()};
+        static_write(out, Value);
+        return result;
+    }
+
+    /** one copy of the text per value, formatted by the compiler */
+    template <const auto& Value>
+    inline constexpr auto static_string = static_format<Value>();
+
+}  // namespace pretty::detail
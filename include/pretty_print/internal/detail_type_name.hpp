@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>      // std::size_t
+#include <string_view>  // std::string_view
+#include <typeinfo>     // std::type_info::name
+
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#define PRETTY_PRINT_HAS_CONSTEXPR_TYPE_NAME 1
+#endif
+
+#if !defined(PRETTY_PRINT_HAS_CONSTEXPR_TYPE_NAME) && __has_include(<cxxabi.h>)
+#include <cxxabi.h>  // abi::__cxa_demangle
+#include <cstdlib>   // std::free
+#include <string>    // std::string
+#endif
+
+namespace pretty::detail {
+
+#if defined(PRETTY_PRINT_HAS_CONSTEXPR_TYPE_NAME)
+    /** signature of this function with T spelled out by the compiler */
+    template <class T>
+    constexpr std::string_view signature() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+        return __FUNCSIG__;
+#else
+        return __PRETTY_FUNCTION__;
+#endif
+    }
+
+    /** text around T in signature<T>(), the same for every T, measured on a known type */
+    struct signature_layout {
+        std::size_t prefix;
+        std::size_t suffix;
+    };
+
+    constexpr signature_layout make_signature_layout() noexcept {
+        constexpr std::string_view probe = signature<double>();
+        const std::size_t prefix = probe.find("double");
+        return {prefix, probe.size() - prefix - std::string_view("double").size()};
+    }
+
+    inline constexpr signature_layout type_name_layout = make_signature_layout();
+
+    /** readable name of T, cut out of signature<T>() by the compiler */
+    template <class T>
+    constexpr std::string_view type_name() noexcept {
+        constexpr std::string_view name = signature<T>();
+        return name.substr(type_name_layout.prefix, name.size() - type_name_layout.prefix - type_name_layout.suffix);
+    }
+#else
+    /** readable name of T, demangled once per type where the ABI allows it */
+    template <class T>
+    std::string_view type_name() {
+#if __has_include(<cxxabi.h>)
+        static const std::string name = [] {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(typeid(T).name(), nullptr, nullptr, &status);
+            std::string result = status == 0 ? demangled : typeid(T).name();
+            std::free(demangled);
+            return result;
+        }();
+        return name;
+#else
+        return typeid(T).name();
+#endif
+    }
+#endif
+
+}  // namespace pretty::detail
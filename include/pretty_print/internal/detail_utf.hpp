@@ -0,0 +1,219 @@
+#pragma once
+#include <algorithm>    // std::min
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint32_t
+#include <string>       // std::basic_string, std::string
+#include <string_view>  // std::basic_string_view, std::string_view
+#include <type_traits>  // std::bool_constant, std::remove_const_t
+
+#include "detail_escape.hpp"
+
+namespace pretty::detail {
+
+    template <typename T>
+    inline constexpr bool is_wide_char_v =
+        std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t> || std::is_same_v<T, wchar_t>;
+
+    template <typename CharT>
+    struct wide_string_of : std::bool_constant<is_wide_char_v<CharT>> {
+        using char_type = CharT;
+    };
+
+    template <typename T>
+    struct is_wide_string : std::false_type {};
+    template <typename CharT, typename Traits, typename Alloc>
+    struct is_wide_string<std::basic_string<CharT, Traits, Alloc>> : wide_string_of<CharT> {};
+    template <typename CharT, typename Traits>
+    struct is_wide_string<std::basic_string_view<CharT, Traits>> : wide_string_of<CharT> {};
+    template <typename CharT, std::size_t N>
+    struct is_wide_string<CharT[N]> : wide_string_of<std::remove_const_t<CharT>> {};
+    template <typename CharT>
+    struct is_wide_string<CharT*> : wide_string_of<std::remove_const_t<CharT>> {};
+
+    /** std::u16string, std::u32string, std::wstring, their views, arrays and pointers,
+     * printed to narrow streams as quoted UTF-8 */
+    template <typename T>
+    inline constexpr bool is_wide_string_v = is_wide_string<T>::value;
+
+    /** code units of 2 bytes are UTF-16 (char16_t, wchar_t on Windows), of 4 bytes UTF-32 */
+    template <class CharT>
+    inline constexpr bool is_utf16_v = sizeof(CharT) == 2;
+
+    /** most bytes one code unit can produce: 4 for a code point past U+FFFF or an \xHH escape */
+    inline constexpr std::size_t utf8_bytes_per_unit = 4;
+
+    inline char* encode_utf8(std::uint32_t c, char* out) noexcept {
+        if (c < 0x80) {
+            *out++ = static_cast<char>(c);
+        } else if (c < 0x800) {
+            *out++ = static_cast<char>(0xc0 | (c >> 6));
+            *out++ = static_cast<char>(0x80 | (c & 0x3f));
+        } else if (c < 0x10000) {
+            *out++ = static_cast<char>(0xe0 | (c >> 12));
+            *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (c & 0x3f));
+        } else {
+            *out++ = static_cast<char>(0xf0 | (c >> 18));
+            *out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+            *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (c & 0x3f));
+        }
+        return out;
+    }
+
+    /** code units copied as one byte: ASCII, without the escape candidates of write_quoted when Quoted */
+    template <bool Quoted>
+    constexpr bool is_plain_unit(std::uint32_t c) noexcept {
+        return Quoted ? c < 0x80 && !is_escape_candidate(static_cast<unsigned char>(c)) : c < 0x80;
+    }
+
+#if defined(PRETTY_PRINT_HAS_SSE2)
+    /** lanes of the 8 UTF-16 units in v that are plain units, see is_plain_unit */
+    template <bool Quoted>
+    __m128i plain_units16(__m128i v) noexcept {
+        if constexpr (Quoted) {
+            // signed compare: units >= 0x8000 are negative and fail "greater than 0x1f"
+            const __m128i printable = _mm_and_si128(_mm_cmpgt_epi16(v, _mm_set1_epi16(0x1f)),
+                                                    _mm_cmplt_epi16(v, _mm_set1_epi16(0x7f)));
+            const __m128i special = _mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16('"')),
+                                                 _mm_cmpeq_epi16(v, _mm_set1_epi16('\\')));
+            return _mm_andnot_si128(special, printable);
+        } else {
+            return _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xff80))), _mm_setzero_si128());
+        }
+    }
+
+    /** lanes of the 4 UTF-32 units in v that are plain units, see is_plain_unit */
+    template <bool Quoted>
+    __m128i plain_units32(__m128i v) noexcept {
+        if constexpr (Quoted) {
+            const __m128i printable = _mm_and_si128(_mm_cmpgt_epi32(v, _mm_set1_epi32(0x1f)),
+                                                    _mm_cmplt_epi32(v, _mm_set1_epi32(0x7f)));
+            const __m128i special = _mm_or_si128(_mm_cmpeq_epi32(v, _mm_set1_epi32('"')),
+                                                 _mm_cmpeq_epi32(v, _mm_set1_epi32('\\')));
+            return _mm_andnot_si128(special, printable);
+        } else {
+            return _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(static_cast<int>(0xffffff80))),
+                                   _mm_setzero_si128());
+        }
+    }
+#endif
+
+    /** copy the leading plain code units of [first, last) to out as bytes, 8 at a time with SSE2
+     * @return the first unit that is not plain */
+    template <bool Quoted, class CharT>
+    const CharT* copy_plain(const CharT* first, const CharT* last, char*& out) noexcept {
+#if defined(PRETTY_PRINT_HAS_SSE2)
+        for (; last - first >= 8; first += 8, out += 8) {
+            __m128i plain;
+            __m128i bytes;
+            if constexpr (is_utf16_v<CharT>) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+                plain = plain_units16<Quoted>(v);
+                bytes = _mm_packus_epi16(v, v);
+            } else {
+                const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+                const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + 4));
+                plain = _mm_packs_epi32(plain_units32<Quoted>(lo), plain_units32<Quoted>(hi));
+                const __m128i words = _mm_packs_epi32(lo, hi);
+                bytes = _mm_packus_epi16(words, words);
+            }
+            // the bytes of units that are not plain are garbage, they are overwritten by the caller
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out), bytes);
+            const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(plain));
+            if (mask != 0xffff) {
+                const unsigned n = count_trailing_zeros(~mask) / 2;
+                out += n;
+                return first + n;
+            }
+        }
+#endif
+        for (; first != last && is_plain_unit<Quoted>(static_cast<std::uint32_t>(*first)); ++first) {
+            *out++ = static_cast<char>(*first);
+        }
+        return first;
+    }
+
+    /** transcode [first, last) to UTF-8 at out, which has room for utf8_bytes_per_unit bytes per unit;
+     * unpaired surrogates and values past U+10FFFF become U+FFFD, so the result is always valid UTF-8;
+     * when Quoted, ASCII escape candidates are escaped as write_quoted does
+     * @return end of the written bytes */
+    template <bool Quoted, class CharT>
+    char* transcode_utf8(const CharT* first, const CharT* last, char* out) noexcept {
+        while (first != last) {
+            first = copy_plain<Quoted>(first, last, out);
+            for (; first != last && !is_plain_unit<Quoted>(static_cast<std::uint32_t>(*first)); ++first) {
+                std::uint32_t c = static_cast<std::uint32_t>(*first);
+                if constexpr (is_utf16_v<CharT>) {
+                    c &= 0xffff;
+                    if (c >= 0xd800 && c <= 0xdbff && last - first >= 2) {
+                        const auto low = static_cast<std::uint32_t>(first[1]) & 0xffff;
+                        if (low >= 0xdc00 && low <= 0xdfff) {
+                            c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+                            ++first;
+                        }
+                    }
+                }
+                if (Quoted && c < 0x80) {
+                    out = escape_byte(static_cast<unsigned char>(c), out);
+                    continue;
+                }
+                if ((c >= 0xd800 && c <= 0xdfff) || c > 0x10ffff) {
+                    c = 0xfffd;
+                }
+                out = encode_utf8(c, out);
+            }
+        }
+        return out;
+    }
+
+    /** most code units write_quoted_units takes at once */
+    inline constexpr std::size_t utf_slice_units = 256;
+
+    /** end of the slice of [first, last) that is transcoded in one go: at most utf_slice_units units, never
+     * between the two units of a surrogate pair */
+    template <class CharT>
+    const CharT* utf_slice_end(const CharT* first, const CharT* last) noexcept {
+        const CharT* end = first + std::min(utf_slice_units, static_cast<std::size_t>(last - first));
+        if constexpr (is_utf16_v<CharT>) {
+            const auto unit = static_cast<std::uint32_t>(end[-1]) & 0xffff;
+            if (end != last && unit >= 0xd800 && unit <= 0xdbff) {
+                ++end;
+            }
+        }
+        return end;
+    }
+
+    /** write a slice of code units, see utf_slice_end, as UTF-8 escaped as write_quoted escapes, through a stack
+     * buffer */
+    template <class Writer, class CharT>
+    void write_quoted_units(Writer& out, const CharT* first, const CharT* last) {
+        char buf[(utf_slice_units + 1) * utf8_bytes_per_unit];
+        out.write(buf, static_cast<std::size_t>(transcode_utf8<true>(first, last, buf) - buf));
+    }
+
+    /** write str in double quotes as write_quoted writes its UTF-8 text, transcoded and escaped in one pass
+     * slice by slice */
+    template <class Writer, class CharT, class Traits>
+    void write_quoted_utf(Writer& out, std::basic_string_view<CharT, Traits> str) {
+        const CharT* it = str.data();
+        const CharT* const last = str.data() + str.size();
+        out.put('"');
+        while (it != last) {
+            const CharT* const end = utf_slice_end(it, last);
+            write_quoted_units(out, it, end);
+            it = end;
+        }
+        out.put('"');
+    }
+
+    /** UTF-8 copy of str, see transcode_utf8 */
+    template <class CharT, class Traits>
+    std::string to_utf8(std::basic_string_view<CharT, Traits> str) {
+        std::string result(str.size() * utf8_bytes_per_unit, '\0');
+        char* const end = transcode_utf8<false>(str.data(), str.data() + str.size(), result.data());
+        result.resize(static_cast<std::size_t>(end - result.data()));
+        return result;
+    }
+
+}  // namespace pretty::detail
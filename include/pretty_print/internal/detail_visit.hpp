@@ -0,0 +1,399 @@
+#pragma once
+#include <charconv>     // std::to_chars
+#include <cmath>        // std::isfinite
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint8_t, std::uint64_t, std::int64_t, INT8_MIN, UINT16_MAX
+#include <cstdio>       // std::snprintf
+#include <cstring>      // std::memcpy
+#include <iterator>     // std::begin, std::end, std::distance
+#include <ostream>      // std::ostream
+#include <string>       // std::string
+#include <string_view>  // std::string_view
+#include <tuple>        // std::tuple, std::apply
+#include <type_traits>  // std::is_integral_v, std::is_floating_point_v
+#include <utility>      // std::pair, std::index_sequence
+#include <vector>       // std::vector
+
+#include "detail_writer.hpp"
+
+namespace pretty::detail {
+
+    template <typename T>
+    struct is_std_string : std::false_type {};
+    template <typename Alloc>
+    struct is_std_string<std::basic_string<char, std::char_traits<char>, Alloc>> : std::true_type {};
+
+    /** the text of a type known only through operator<<(std::ostream&, const T&) */
+    template <class T>
+    std::string to_text(const T& data) {
+        std::string str;
+        {
+            string_writer<std::string> out(str);
+            out << data;
+        }
+        return str;
+    }
+
+    template <class Backend, class T>
+    void traverse(Backend& out, const T& data);
+
+    template <class Backend, class Tuple, std::size_t... Is>
+    void traverse_tuple(Backend& out, const Tuple& data, std::index_sequence<Is...>) {
+        ((out.element(Is), traverse(out, std::get<Is>(data))), ...);
+    }
+
+    /** walk data in the order and with the type dispatch of ostream::ostream_impl, see print_kind_of,
+     * emitting events to out:
+     * begin_array/end_array, begin_map/end_map, begin_tuple/end_tuple, begin_struct/end_struct
+     * for aggregates, begin_pair/end_pair,
+     * element(index) before every element, key() between a key and its value,
+     * null, boolean, integer, floating, character, string for scalars and text for types known only through
+     * operator<< */
+    template <class Backend, class T>
+    void traverse(Backend& out, const T& data) {
+        constexpr print_kind kind = print_kind_of<std::ostream, T>();
+        if constexpr (kind == print_kind::lazy) {
+            if constexpr (is_lazy_args<T>::value) {
+                out.text(data);
+            } else {
+                traverse(out, data.get());
+            }
+        } else if constexpr (kind == print_kind::pair) {
+            out.begin_pair();
+            traverse(out, data.first);
+            out.key();
+            traverse(out, data.second);
+            out.end_pair();
+        } else if constexpr (kind == print_kind::tuple) {
+            out.begin_tuple(std::tuple_size_v<T>);
+            traverse_tuple(out, data, std::make_index_sequence<std::tuple_size_v<T>>{});
+            out.end_tuple();
+        } else if constexpr (kind == print_kind::optional) {
+            if (data) {
+                traverse(out, *data);
+            } else {
+                out.null();
+            }
+        } else if constexpr (kind == print_kind::variant) {
+            if (data.index() == std::variant_npos) {
+                out.text(std::string_view("VARIANT_NPOS"));
+            } else {
+                std::visit([&out](const auto& value) { traverse(out, value); }, data);
+            }
+        } else if constexpr (kind == print_kind::wide_string) {
+            out.string(to_utf8(quoted_wide(data).str));
+        } else if constexpr (kind == print_kind::container) {
+            std::size_t size = 0;
+            if constexpr (has_size_v<T>) {
+                size = static_cast<std::size_t>(std::size(data));
+            } else {
+                size = static_cast<std::size_t>(std::distance(std::begin(data), std::end(data)));
+            }
+            std::size_t i = 0;
+            if constexpr (is_map_v<T>) {
+                out.begin_map(size);
+                for (const auto& el : data) {
+                    out.element(i++);
+                    traverse(out, el.first);
+                    out.key();
+                    traverse(out, el.second);
+                }
+                out.end_map();
+            } else {
+                out.begin_array(size);
+                for (const auto& el : data) {
+                    out.element(i++);
+                    traverse(out, el);
+                }
+                out.end_array();
+            }
+        } else if constexpr (kind == print_kind::text) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(quoted_helper(data))>, quoted_view<char>>) {
+                out.string(quoted_helper(data).str);
+            } else if constexpr (std::is_same_v<T, bool>) {
+                out.boolean(data);
+            } else if constexpr (is_narrow_char_v<T>) {
+                out.character(static_cast<char>(data));
+            } else if constexpr (std::is_integral_v<T>) {
+                out.integer(data);
+            } else if constexpr (std::is_floating_point_v<T>) {
+                out.floating(data);
+            } else {
+                out.text(data);
+            }
+        } else if constexpr (kind == print_kind::enumeration) {
+            out.integer(static_cast<std::underlying_type_t<T>>(data));
+        } else if constexpr (kind == print_kind::aggregate) {
+            const auto fields = tie_fields(data);
+            constexpr std::size_t size = std::tuple_size_v<decltype(fields)>;
+            out.begin_struct(size);
+            traverse_tuple(out, fields, std::make_index_sequence<size>{});
+            out.end_struct();
+        } else {
+            static_assert(kind != print_kind::unsupported,
+                          "not support [ostream& operator<<(ostream& out, const T& data)]");
+        }
+    }
+
+}  // namespace pretty::detail
+
+namespace pretty {
+
+    /** backend for pretty::visit producing the text of pretty::print */
+    template <class Stream>
+    class text_backend {
+    public:
+        explicit text_backend(Stream& out) noexcept : out_(out) {}
+
+        void begin_array(std::size_t) { out_ << '['; }
+        void end_array() { out_ << ']'; }
+        void begin_map(std::size_t) { out_ << '{'; }
+        void end_map() { out_ << '}'; }
+        void begin_tuple(std::size_t) { out_ << '('; }
+        void end_tuple() { out_ << ')'; }
+        void begin_struct(std::size_t) { out_ << '{'; }
+        void end_struct() { out_ << '}'; }
+        void begin_pair() {}
+        void end_pair() {}
+        void element(std::size_t index) {
+            if (index != 0) {
+                out_ << ", ";
+            }
+        }
+        void key() { out_ << ": "; }
+
+        void null() { out_ << "null"; }
+        void boolean(bool value) { out_ << value; }
+        template <class T>
+        void integer(T value) {
+            out_ << value;
+        }
+        template <class T>
+        void floating(T value) {
+            out_ << value;
+        }
+        void character(char value) { out_ << value; }
+        void string(std::string_view value) { out_ << detail::quoted_view<char>{value}; }
+        template <class T>
+        void text(const T& value) {
+            out_ << value;
+        }
+
+    private:
+        Stream& out_;
+    };
+
+    /** backend for pretty::visit producing strict JSON: arrays for containers, tuples and pairs, objects for maps
+     * map keys that are not strings are written as the JSON string of their JSON text,
+     * types known only through operator<< as the JSON string of their text, NaN and infinities as null */
+    class json_backend {
+    public:
+        explicit json_backend(std::string& out) noexcept : out_(out) {}
+
+        void begin_array(std::size_t) { open('[', false); }
+        void end_array() { close(']'); }
+        void begin_map(std::size_t) { open('{', true); }
+        void end_map() { close('}'); }
+        void begin_tuple(std::size_t) { open('[', false); }
+        void end_tuple() { close(']'); }
+        void begin_struct(std::size_t) { open('[', false); }
+        void end_struct() { close(']'); }
+        void begin_pair() { open('[', false); }
+        void end_pair() { close(']'); }
+        void element(std::size_t index) {
+            if (index != 0) {
+                out_.push_back(',');
+            }
+            frames_.back().key_start = out_.size();
+        }
+        void key() {
+            frame& top = frames_.back();
+            if (!top.map) {
+                out_.push_back(',');
+                return;
+            }
+            if (out_[top.key_start] != '"') {
+                const std::string key = out_.substr(top.key_start);
+                out_.resize(top.key_start);
+                string(key);
+            }
+            out_.push_back(':');
+        }
+
+        void null() { out_.append("null"); }
+        void boolean(bool value) { out_.append(value ? "true" : "false"); }
+        template <class T>
+        void integer(T value) {
+            char buf[24];
+            out_.append(buf, detail::write_integer(buf, value));
+        }
+        template <class T>
+        void floating(T value) {
+            if (!std::isfinite(value)) {
+                null();
+                return;
+            }
+            // at the precision of T: 0.1f is 0.1, not the 0.10000000149011612 of the double it converts to
+            char buf[64];
+#if defined(__cpp_lib_to_chars)
+            out_.append(buf, std::to_chars(buf, buf + sizeof(buf), value).ptr);
+#else
+            const int n = std::snprintf(buf, sizeof(buf), std::is_same_v<T, float> ? "%.9g" : "%.17g",
+                                        static_cast<double>(value));
+            out_.append(buf, static_cast<std::size_t>(n));
+#endif
+        }
+        void character(char value) { string(std::string_view(&value, 1)); }
+        void string(std::string_view value) {
+            struct {
+                std::string& str;
+                void write(const char* s, std::size_t n) { str.append(s, n); }
+                void put(char c) { str.push_back(c); }
+            } writer{out_};
+            detail::write_json_string(writer, value);
+        }
+        template <class T>
+        void text(const T& value) {
+            string(detail::to_text(value));
+        }
+
+    private:
+        struct frame {
+            bool map;
+            std::size_t key_start;
+        };
+
+        void open(char bracket, bool map) {
+            out_.push_back(bracket);
+            frames_.push_back({map, out_.size()});
+        }
+        void close(char bracket) {
+            frames_.pop_back();
+            out_.push_back(bracket);
+        }
+
+        std::string& out_;
+        std::vector<frame> frames_;
+    };
+
+    /** backend for pretty::visit producing MessagePack: arrays for containers, tuples and pairs, maps for maps,
+     * types known only through operator<< as the str of their text */
+    class msgpack_backend {
+    public:
+        explicit msgpack_backend(std::string& out) noexcept : out_(out) {}
+
+        void begin_array(std::size_t size) { header(size, 0x90, 16, 0xdc); }
+        void end_array() {}
+        void begin_map(std::size_t size) { header(size, 0x80, 16, 0xde); }
+        void end_map() {}
+        void begin_tuple(std::size_t size) { begin_array(size); }
+        void end_tuple() {}
+        void begin_struct(std::size_t size) { begin_array(size); }
+        void end_struct() {}
+        void begin_pair() { begin_array(2); }
+        void end_pair() {}
+        void element(std::size_t) {}
+        void key() {}
+
+        void null() { byte(0xc0); }
+        void boolean(bool value) { byte(value ? 0xc3 : 0xc2); }
+        template <class T>
+        void integer(T value) {
+            if constexpr (std::is_signed_v<T>) {
+                if (value < 0) {
+                    const auto v = static_cast<std::int64_t>(value);
+                    if (v >= -32) {
+                        byte(static_cast<std::uint8_t>(v));
+                    } else if (v >= INT8_MIN) {
+                        byte(0xd0);
+                        big_endian(static_cast<std::uint8_t>(v));
+                    } else if (v >= INT16_MIN) {
+                        byte(0xd1);
+                        big_endian(static_cast<std::uint16_t>(v));
+                    } else if (v >= INT32_MIN) {
+                        byte(0xd2);
+                        big_endian(static_cast<std::uint32_t>(v));
+                    } else {
+                        byte(0xd3);
+                        big_endian(static_cast<std::uint64_t>(v));
+                    }
+                    return;
+                }
+            }
+            const auto v = static_cast<std::uint64_t>(value);
+            if (v <= 0x7f) {
+                byte(static_cast<std::uint8_t>(v));
+            } else if (v <= UINT8_MAX) {
+                byte(0xcc);
+                big_endian(static_cast<std::uint8_t>(v));
+            } else if (v <= UINT16_MAX) {
+                byte(0xcd);
+                big_endian(static_cast<std::uint16_t>(v));
+            } else if (v <= UINT32_MAX) {
+                byte(0xce);
+                big_endian(static_cast<std::uint32_t>(v));
+            } else {
+                byte(0xcf);
+                big_endian(v);
+            }
+        }
+        template <class T>
+        void floating(T value) {
+            if constexpr (std::is_same_v<T, float>) {
+                std::uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                byte(0xca);
+                big_endian(bits);
+            } else {
+                const auto v = static_cast<double>(value);
+                std::uint64_t bits;
+                std::memcpy(&bits, &v, sizeof(bits));
+                byte(0xcb);
+                big_endian(bits);
+            }
+        }
+        void character(char value) { string(std::string_view(&value, 1)); }
+        void string(std::string_view value) {
+            if (value.size() < 32) {
+                byte(static_cast<std::uint8_t>(0xa0 | value.size()));
+            } else if (value.size() <= UINT8_MAX) {
+                byte(0xd9);
+                big_endian(static_cast<std::uint8_t>(value.size()));
+            } else {
+                header(value.size(), 0, 0, 0xda);
+            }
+            out_.append(value);
+        }
+        template <class T>
+        void text(const T& value) {
+            string(detail::to_text(value));
+        }
+
+    private:
+        void byte(std::uint8_t value) { out_.push_back(static_cast<char>(value)); }
+
+        template <class T>
+        void big_endian(T value) {
+            for (std::size_t i = sizeof(T); i-- > 0;) {
+                byte(static_cast<std::uint8_t>(value >> (8 * i)));
+            }
+        }
+
+        /** fix header with the size in its low bits below fix_limit,
+         * else the 16-bit size marker or the 32-bit one that follows it */
+        void header(std::size_t size, std::uint8_t fix, std::size_t fix_limit, std::uint8_t marker16) {
+            if (size < fix_limit) {
+                byte(static_cast<std::uint8_t>(fix | size));
+            } else if (size <= UINT16_MAX) {
+                byte(marker16);
+                big_endian(static_cast<std::uint16_t>(size));
+            } else {
+                byte(static_cast<std::uint8_t>(marker16 + 1));
+                big_endian(static_cast<std::uint32_t>(size));
+            }
+        }
+
+        std::string& out_;
+    };
+
+}  // namespace pretty
@@ -0,0 +1,465 @@
+#pragma once
+#include <algorithm>    // std::copy_n, std::max, std::min
+#include <charconv>     // std::to_chars
+#include <cstddef>      // std::size_t
+#include <cstring>      // std::memcpy, std::strlen
+#include <optional>     // std::optional
+#include <ostream>      // std::ostream
+#include <streambuf>    // std::streambuf
+#include <string>       // std::basic_string
+#include <string_view>  // std::string_view
+#include <type_traits>  // std::enable_if_t, std::is_integral_v
+#include <utility>      // std::swap
+
+#include "detail_pretty_print.hpp"
+
+#if __has_include(<memory_resource>)
+#include <memory_resource>  // std::pmr::memory_resource
+#endif
+
+namespace pretty::detail {
+
+    /** streambuf forwarding every byte to a type-erased writer */
+    class forward_streambuf : public std::streambuf {
+    public:
+        using write_fn = void (*)(void*, const char*, std::size_t);
+
+        struct target_type {
+            void* context = nullptr;
+            write_fn write = nullptr;
+        };
+
+        target_type target(target_type target) noexcept {
+            std::swap(target_, target);
+            return target;
+        }
+
+    protected:
+        int_type overflow(int_type ch) override {
+            if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+                const char c = traits_type::to_char_type(ch);
+                target_.write(target_.context, &c, 1);
+            }
+            return traits_type::not_eof(ch);
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override {
+            target_.write(target_.context, s, static_cast<std::size_t>(n));
+            return n;
+        }
+
+    private:
+        target_type target_;
+    };
+
+    /** per-thread std::ostream used for types that only know operator<<(std::ostream&, const T&) */
+    class fallback_ostream : public std::ostream {
+    public:
+        fallback_ostream() : std::ostream(&buf_) {}
+
+        /** in the formatting state of format, its iword and pword included, see value_format */
+        explicit fallback_ostream(const std::ostream& format) : std::ostream(&buf_) {
+            copyfmt(format);
+            width(0);
+        }
+
+        forward_streambuf::target_type target(forward_streambuf::target_type target) noexcept {
+            return buf_.target(target);
+        }
+
+        void reset() {
+            clear();
+            flags(std::ios_base::skipws | std::ios_base::dec);
+            precision(6);
+            width(0);
+            fill(' ');
+        }
+
+        static fallback_ostream& instance() {
+            thread_local fallback_ostream out;
+            return out;
+        }
+
+    private:
+        forward_streambuf buf_;
+    };
+
+    template <typename T>
+    inline constexpr bool is_narrow_char_v = is_same_any_of_v<T, char, signed char, unsigned char>;
+
+    template <typename T>
+    struct is_narrow_string : std::false_type {};
+    template <typename Alloc>
+    struct is_narrow_string<std::basic_string<char, std::char_traits<char>, Alloc>> : std::true_type {};
+    template <>
+    struct is_narrow_string<std::string_view> : std::true_type {};
+
+    template <typename T>
+    inline constexpr bool is_narrow_string_v = is_narrow_string<T>::value;
+
+    template <typename T>
+    struct is_wide_quoted_view : std::false_type {};
+    template <typename CharT, typename Traits>
+    struct is_wide_quoted_view<quoted_view<CharT, Traits>> : std::bool_constant<is_wide_char_v<CharT>> {};
+
+    template <typename T>
+    inline constexpr bool is_wide_quoted_view_v = is_wide_quoted_view<T>::value;
+
+    /** how a writer forwarding to a std::ostream prints values whose text depends on the state of the stream:
+     * numbers and bool through a fallback_ostream formatted as the stream if its flags, precision or locale differ
+     * from the default, e.g. in hex or with std::boolalpha, and types with an operator<< of their own through it
+     * always, so that they see its iword and pword too; the fallback_ostream is made on first use, once per call,
+     * characters, strings and the text of the writer itself are written as they are */
+    class value_format {
+    public:
+        /** writers not forwarding to a std::ostream format every value themselves */
+        value_format() = default;
+        explicit value_format(const std::ostream& source)
+            : source_(&source), default_format_(detail::has_default_format(source)) {}
+        /** the one of another writer, e.g. a counter measuring the text of the writer's values */
+        explicit value_format(value_format& shared) noexcept : shared_(&shared) {}
+
+        value_format(const value_format&) = delete;
+        value_format& operator=(const value_format&) = delete;
+
+        bool has_default_format() const noexcept { return shared_ ? shared_->has_default_format() : default_format_; }
+
+        /** the stream to print data through, nullptr if the writer formats it */
+        template <class T>
+        fallback_ostream* stream_for() {
+            if (shared_) {
+                return shared_->stream_for<T>();
+            }
+            if (!source_ || (std::is_arithmetic_v<T> && default_format_)) {
+                return nullptr;
+            }
+            if (!stream_) {
+                stream_.emplace(*source_);
+            }
+            return &*stream_;
+        }
+
+    private:
+        value_format* shared_ = nullptr;
+        const std::ostream* source_ = nullptr;
+        bool default_format_ = true;
+        std::optional<fallback_ostream> stream_;
+    };
+
+    /** the value_format of a writer forwarding to out */
+    template <class Sink>
+    value_format make_value_format(const Sink& out) {
+        if constexpr (std::is_base_of_v<std::ostream, Sink>) {
+            return value_format(out);
+        } else {
+            return value_format();
+        }
+    }
+
+    /** iostream-free output with the same text as std::ostream in its default state
+     * Derived must provide write(const char*, std::size_t) and put(char) */
+    template <class Derived>
+    class basic_writer {
+    public:
+        template <class T, typename = std::enable_if_t<has_ostream_operator_v<std::ostream, T>>>
+        Derived& operator<<(const T& data) {
+            if constexpr (has_value_format_v<Derived> && !is_narrow_char_v<T> && !std::is_array_v<T> &&
+                          !std::is_pointer_v<T> && !is_narrow_string_v<T> && !std::is_same_v<T, quoted_view<char>> &&
+                          !is_wide_quoted_view_v<T>) {
+                if (fallback_ostream* format = self().format().template stream_for<T>()) {
+                    write_fallback(*format, data);
+                    format->clear();
+                    return self();
+                }
+            }
+            if constexpr (std::is_same_v<T, bool>) {
+                self().put(data ? '1' : '0');
+            } else if constexpr (is_narrow_char_v<T>) {
+                self().put(static_cast<char>(data));
+            } else if constexpr (std::is_integral_v<T> && is_counting_writer_v<Derived>) {
+                self().skip(integer_size(+data));
+            } else if constexpr (std::is_integral_v<T>) {
+                char buf[24];
+                self().write(buf, static_cast<std::size_t>(write_integer(buf, +data) - buf));
+#if defined(__cpp_lib_to_chars)
+            } else if constexpr (std::is_floating_point_v<T>) {
+                using float_type = std::conditional_t<std::is_same_v<T, long double>, long double, double>;
+                char buf[64];
+                const auto result = std::to_chars(buf, buf + sizeof(buf), static_cast<float_type>(data),
+                                                  std::chars_format::general, 6);
+                self().write(buf, static_cast<std::size_t>(result.ptr - buf));
+#endif
+            } else if constexpr (std::is_array_v<T> && is_narrow_char_v<std::remove_extent_t<T>>) {
+                self().write(reinterpret_cast<const char*>(data), std::strlen(reinterpret_cast<const char*>(data)));
+            } else if constexpr (is_same_any_of_v<T, const char*, char*>) {
+                self().write(data, std::strlen(data));
+            } else if constexpr (is_narrow_string_v<T>) {
+                self().write(data.data(), data.size());
+            } else if constexpr (std::is_same_v<T, quoted_view<char>> && is_limited_writer_v<Derived>) {
+                write_quoted(self(), self().visible(data.str));
+            } else if constexpr (std::is_same_v<T, quoted_view<char>>) {
+                write_quoted(self(), data.str);
+            } else if constexpr (is_wide_quoted_view_v<T> && is_limited_writer_v<Derived>) {
+                write_quoted_utf(self(), self().visible(data.str));
+            } else if constexpr (is_wide_quoted_view_v<T>) {
+                write_quoted_utf(self(), data.str);
+            } else {
+                auto& out = fallback_ostream::instance();
+                write_fallback(out, data);
+                out.reset();
+            }
+            return self();
+        }
+
+    private:
+        Derived& self() noexcept { return static_cast<Derived&>(*this); }
+
+        template <class T>
+        void write_fallback(fallback_ostream& out, const T& data) {
+            const auto saved = out.target({this, [](void* context, const char* s, std::size_t n) {
+                                               static_cast<basic_writer*>(context)->self().write(s, n);
+                                           }});
+            out << data;
+            out.target(saved);
+        }
+    };
+
+    /** writer to an output iterator, std::copy_n keeps raw char pointers on the memmove path */
+    template <class OutputIt>
+    class iterator_writer : public basic_writer<iterator_writer<OutputIt>> {
+    public:
+        explicit iterator_writer(OutputIt out) : out_(out) {}
+
+        void write(const char* s, std::size_t n) { out_ = std::copy_n(s, n, out_); }
+        void put(char c) {
+            *out_ = c;
+            ++out_;
+        }
+
+        OutputIt out() const { return out_; }
+
+    private:
+        OutputIt out_;
+    };
+
+    /** writer appending to a std::basic_string
+     * the string is grown ahead in chunks and written in place, its final size is set on destruction */
+    template <class String>
+    class string_writer : public basic_writer<string_writer<String>> {
+    public:
+        explicit string_writer(String& out) noexcept : out_(out), begin_(out.size()), size_(begin_) {}
+        ~string_writer() { out_.resize(size_); }
+
+        string_writer(const string_writer&) = delete;
+        string_writer& operator=(const string_writer&) = delete;
+
+        void write(const char* s, std::size_t n) {
+            if (n == 0) {
+                return;
+            }
+            if (n > out_.size() - size_) {
+                grow(n);
+            }
+            std::memcpy(out_.data() + size_, s, n);
+            size_ += n;
+        }
+        void put(char c) {
+            if (size_ == out_.size()) {
+                grow(1);
+            }
+            out_[size_++] = c;
+        }
+
+    private:
+        /** grow by at least what was written so far, so filling the chunk stays linear in the output;
+         * never past a capacity that still holds n more characters, so a string reserved ahead by print
+         * is filled without allocating again */
+        void grow(std::size_t n) {
+            std::size_t size = size_ + std::max({n, size_ - begin_, std::size_t{64}});
+            if (size_ + n <= out_.capacity()) {
+                size = std::min(size, out_.capacity());
+            }
+            out_.resize(size);
+        }
+
+        String& out_;
+        std::size_t begin_;
+        std::size_t size_;
+    };
+
+    /** writer that only counts the characters it would write */
+    class counting_writer : public basic_writer<counting_writer> {
+    public:
+        void write(const char*, std::size_t n) noexcept { size_ += n; }
+        void put(char) noexcept { ++size_; }
+        void skip(std::size_t n) noexcept { size_ += n; }
+
+        std::size_t size() const noexcept { return size_; }
+
+    private:
+        std::size_t size_ = 0;
+    };
+
+    /** writer forwarding to out until limits.max_bytes characters are written, then "..." once */
+    template <class Sink>
+    class limited_writer : public basic_writer<limited_writer<Sink>> {
+    public:
+        limited_writer(Sink& out, const pretty::limits& limits)
+            : out_(out), limits_(limits), left_(limits.max_bytes), format_(make_value_format(out)) {}
+        /** values printed as by the writer that format belongs to */
+        limited_writer(Sink& out, const pretty::limits& limits, value_format& format) noexcept
+            : out_(out), limits_(limits), left_(limits.max_bytes), format_(format) {}
+
+        void write(const char* s, std::size_t n) {
+            if (n > left_) {
+                cut(s, n);
+                return;
+            }
+            out_.write(s, n);
+            left_ -= n;
+        }
+        void put(char c) {
+            if (left_ == 0) {
+                cut(&c, 1);
+                return;
+            }
+            out_.put(c);
+            --left_;
+        }
+
+        const pretty::limits& limits() const noexcept { return limits_; }
+        bool exhausted() const noexcept { return exhausted_; }
+        value_format& format() noexcept { return format_; }
+        const value_format& format() const noexcept { return format_; }
+
+        /** the part of str that can show before the cut: escaping never makes a code unit shorter than one
+         * byte, so a long string is escaped only up to the budget, and a UTF-8 sequence or surrogate pair
+         * split at the end of the part is escaped past it */
+        template <class CharT, class Traits>
+        std::basic_string_view<CharT, Traits> visible(std::basic_string_view<CharT, Traits> str) const noexcept {
+            if (exhausted_) {
+                return {};
+            }
+            return left_ < str.size() ? str.substr(0, std::min(str.size(), left_ + utf8_bytes_per_unit)) : str;
+        }
+
+    private:
+        void cut(const char* s, std::size_t n) {
+            if (!exhausted_) {
+                out_.write(s, std::min(n, left_));
+                out_.write("...", 3);
+                left_ = 0;
+                exhausted_ = true;
+            }
+        }
+
+        Sink& out_;
+        const pretty::limits& limits_;
+        std::size_t left_;
+        bool exhausted_ = false;
+        value_format format_;
+    };
+
+    /** writer forwarding to out with containers printed over several lines, indented by their depth */
+    template <class Sink>
+    class indent_writer : public basic_writer<indent_writer<Sink>> {
+    public:
+        indent_writer(Sink& out, const pretty::indent& indent)
+            : out_(out), indent_(indent), format_(make_value_format(out)) {}
+
+        void write(const char* s, std::size_t n) { out_.write(s, n); }
+        void put(char c) { out_.put(c); }
+
+        value_format& format() noexcept { return format_; }
+        const value_format& format() const noexcept { return format_; }
+
+        bool multiline() const noexcept { return multiline_; }
+        void multiline(bool value) noexcept { multiline_ = value; }
+
+        /** line break followed by the indentation of depth, written from one precomputed run of spaces */
+        void newline(std::size_t depth) {
+            static constexpr char prefix[] = "\n                                                                ";
+            constexpr std::size_t spaces = sizeof(prefix) - 2;
+            std::size_t n = depth * indent_.width;
+            const std::size_t first = std::min(n, spaces);
+            out_.write(prefix, 1 + first);
+            for (n -= first; n > 0; n -= std::min(n, spaces)) {
+                out_.write(prefix + 1, std::min(n, spaces));
+            }
+        }
+
+        /** true if the single-line text of data is at most inline_width, counting stops past the budget */
+        template <class T>
+        bool fits(const T& data) {
+            if (indent_.inline_width == 0) {
+                return false;
+            }
+            pretty::limits limits;
+            limits.max_bytes = indent_.inline_width;
+            counting_writer counter;
+            limited_writer<counting_writer> out(counter, limits, format_);
+            ostream::ostream_impl(out, data);
+            return !out.exhausted();
+        }
+
+    private:
+        Sink& out_;
+        const pretty::indent& indent_;
+        bool multiline_ = true;
+        value_format format_;
+    };
+
+    /** writer forwarding to out with unordered containers printed in key order, see sorted_elements */
+    template <class Sink>
+    class sorted_writer : public basic_writer<sorted_writer<Sink>> {
+    public:
+        explicit sorted_writer(Sink& out) : out_(out), format_(make_value_format(out)) {}
+
+        void write(const char* s, std::size_t n) { out_.write(s, n); }
+        void put(char c) { out_.put(c); }
+
+        bool sorts_unordered() const noexcept { return true; }
+        value_format& format() noexcept { return format_; }
+        const value_format& format() const noexcept { return format_; }
+
+    private:
+        Sink& out_;
+        value_format format_;
+    };
+
+    /** writer forwarding to out with pointers printed as their pointees, each object once, see address_set */
+    template <class Sink>
+    class graph_writer : public basic_writer<graph_writer<Sink>> {
+    public:
+        explicit graph_writer(Sink& out) : out_(out), format_(make_value_format(out)) {}
+
+        void write(const char* s, std::size_t n) { out_.write(s, n); }
+        void put(char c) { out_.put(c); }
+
+        address_set& visited() noexcept { return visited_; }
+        value_format& format() noexcept { return format_; }
+        const value_format& format() const noexcept { return format_; }
+
+    private:
+        Sink& out_;
+        address_set visited_;
+        value_format format_;
+    };
+
+    /** per-thread string behind print_view, cleared on every call and keeping its capacity between calls */
+    inline std::string& arena_string() {
+        thread_local std::string str;
+        str.clear();
+        return str;
+    }
+
+    /** types taken by the string-returning print(data, options) overloads instead of a second datum */
+    template <typename T>
+    inline constexpr bool is_print_options_v = is_same_any_of_v<T, pretty::limits, pretty::indent, pretty::sorted_unordered,
+                                                                 pretty::deref_pointers>
+#if __has_include(<memory_resource>)
+        || (std::is_pointer_v<T> && std::is_convertible_v<T, std::pmr::memory_resource*>)
+#endif
+        ;
+
+}  // namespace pretty::detail
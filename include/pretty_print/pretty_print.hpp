@@ -1,10 +1,25 @@
 #pragma once
-#include <sstream>      // std::stringstream
+#include <algorithm>    // std::max
+#include <cstddef>      // std::size_t
 #include <string>       // std::string
+#include <string_view>  // std::string_view
+#include <thread>       // std::thread::hardware_concurrency
 #include <type_traits>  // std::is_same_v
-#include <typeinfo>     // std::type_info::name
+#include <utility>      // std::forward
 
+#include "internal/detail_async.hpp"
+#include "internal/detail_cache.hpp"
+#include "internal/detail_chunked.hpp"
+#include "internal/detail_diff.hpp"
+#include "internal/detail_lazy.hpp"
+#include "internal/detail_parallel.hpp"
+#include "internal/detail_parse.hpp"
 #include "internal/detail_pretty_print.hpp"
+#include "internal/detail_sink.hpp"
+#include "internal/detail_static.hpp"
+#include "internal/detail_type_name.hpp"
+#include "internal/detail_visit.hpp"
+#include "internal/detail_writer.hpp"
 
 namespace pretty {
 
@@ -12,30 +27,243 @@ namespace pretty {
      * @param out Stream
      * @param data data
      * @return Stream */
-    template <class Stream, class T>
+    template <class Stream, class T, typename = std::enable_if_t<!detail::is_print_options_v<T>>>
     constexpr Stream& print(Stream& out, const T& data) {
-        detail::ostream::ostream_impl<0>(out, data);
+        detail::instrument_call call(out);
+        detail::ostream::ostream_impl(call.out(), data);
+        call.finish();
+        return out;
+    }
+
+    /** pretty data print bounded by limits, the cost scales with the limits rather than with data
+     * @param out Stream
+     * @param data data
+     * @param bounds max elements per container, max nesting depth and max characters
+     * @return Stream */
+    template <class Stream, class T>
+    Stream& print(Stream& out, const T& data, const limits& bounds) {
+        detail::instrument_call call(out);
+        detail::limited_writer<detail::instrumented_t<Stream>> writer(call.out(), bounds);
+        detail::ostream::ostream_impl(writer, data);
+        call.finish();
+        return out;
+    }
+
+    /** pretty data print over several lines, every container element on its own indented line
+     * @param out Stream
+     * @param data data
+     * @param layout spaces per nesting level and the width up to which containers stay on one line
+     * @return Stream */
+    template <class Stream, class T>
+    Stream& print(Stream& out, const T& data, const indent& layout) {
+        detail::instrument_call call(out);
+        detail::indent_writer<detail::instrumented_t<Stream>> writer(call.out(), layout);
+        detail::ostream::ostream_impl(writer, data);
+        call.finish();
+        return out;
+    }
+
+    /** pretty data print with unordered containers in key order, the same text on every run
+     * @param out Stream
+     * @param data data
+     * @return Stream */
+    template <class Stream, class T>
+    Stream& print(Stream& out, const T& data, sorted_unordered) {
+        detail::instrument_call call(out);
+        detail::sorted_writer<detail::instrumented_t<Stream>> writer(call.out());
+        detail::ostream::ostream_impl(writer, data);
+        call.finish();
+        return out;
+    }
+
+    /** pretty data print with pointers followed, objects reached again print as <ref #N>
+     * @param out Stream
+     * @param data data
+     * @return Stream */
+    template <class Stream, class T>
+    Stream& print(Stream& out, const T& data, deref_pointers) {
+        detail::instrument_call call(out);
+        detail::graph_writer<detail::instrumented_t<Stream>> writer(call.out());
+        detail::ostream::ostream_impl(writer, data);
+        call.finish();
+        return out;
+    }
+
+    /** pretty data print with the elements of a large random access range formatted on several threads
+     * the output is the same as print(out, data), small ranges, other types and streams with any formatting
+     * flag changed, e.g. std::boolalpha, are printed by print(out, data); the threads are started on every call
+     * and the whole text is held in memory before it is written to out
+     * @param out Stream
+     * @param data data
+     * @param threads number of threads, 0 for std::thread::hardware_concurrency()
+     * @return Stream */
+    template <class Stream, class T>
+    Stream& parallel_print(Stream& out, const T& data, std::size_t threads = 0) {
+        if constexpr (detail::is_parallel_range_v<T> && detail::is_parallel_stream_v<Stream> &&
+                      (!detail::has_ostream_operator_v<Stream, T> || std::is_array_v<T>)) {
+            if (threads == 0) {
+                threads = std::max(std::thread::hardware_concurrency(), 1u);
+            }
+            const auto size = static_cast<std::size_t>(std::end(data) - std::begin(data));
+            if (threads > 1 && size >= detail::parallel_min_size && detail::has_default_format(out)) {
+                detail::parallel_print_impl(out, data, threads);
+                return out;
+            }
+        }
+        return print(out, data);
+    }
+
+    /** pretty data print without iostreams
+     * @param out output iterator, e.g. char* to a caller-owned buffer
+     * @param data data
+     * @return iterator past the last written character */
+    template <class OutputIt, class T>
+    OutputIt format_to(OutputIt out, const T& data) {
+        const detail::instrument_call call(out);
+        detail::iterator_writer<OutputIt> writer(out);
+        detail::ostream::ostream_impl(writer, data);
+        return writer.out();
+    }
+
+    /** pretty data print without iostreams
+     * @param out string to append to
+     * @param data data
+     * @return out */
+    template <class Alloc, class T>
+    std::basic_string<char, std::char_traits<char>, Alloc>& format_to(
+        std::basic_string<char, std::char_traits<char>, Alloc>& out, const T& data) {
+        const detail::instrument_call call(out);
+        {
+            detail::string_writer<std::basic_string<char, std::char_traits<char>, Alloc>> writer(out);
+            detail::ostream::ostream_impl(writer, data);
+        }
         return out;
     }
 
+    /** exact length of the pretty data print, computed without formatting
+     * @param data data
+     * @return number of characters print(data) produces */
+    template <class T>
+    std::size_t formatted_size(const T& data) {
+        [[maybe_unused]] const detail::instrument_sizing sizing;
+        detail::counting_writer writer;
+        detail::ostream::ostream_impl(writer, data);
+        return writer.size();
+    }
+
     /** pretty data print
      * @param data data
      * @return std::string */
     template <class T>
     std::string print(const T& data) {
-        std::stringstream out;
-        print(out, data);
-        return out.str();
+        std::string result;
+        const detail::instrument_call call(result);
+        result.reserve(formatted_size(data));
+        format_to(result, data);
+        return result;
     }
 
-    /** pretty data print with type inforamation at the beginning
+    /** pretty data print bounded by limits
+     * @param data data
+     * @param bounds max elements per container, max nesting depth and max characters
+     * @return std::string */
+    template <class T>
+    std::string print(const T& data, const limits& bounds) {
+        std::string result;
+        const detail::instrument_call call(result);
+        {
+            detail::string_writer<std::string> out(result);
+            print(out, data, bounds);
+        }
+        return result;
+    }
+
+    /** pretty data print over several lines
+     * @param data data
+     * @param layout spaces per nesting level and the width up to which containers stay on one line
+     * @return std::string */
+    template <class T>
+    std::string print(const T& data, const indent& layout) {
+        std::string result;
+        const detail::instrument_call call(result);
+        {
+            detail::string_writer<std::string> out(result);
+            print(out, data, layout);
+        }
+        return result;
+    }
+
+    /** pretty data print with unordered containers in key order
+     * @param data data
+     * @return std::string */
+    template <class T>
+    std::string print(const T& data, sorted_unordered order) {
+        std::string result;
+        const detail::instrument_call call(result);
+        {
+            detail::string_writer<std::string> out(result);
+            print(out, data, order);
+        }
+        return result;
+    }
+
+    /** pretty data print with pointers followed, objects reached again print as <ref #N>
+     * @param data data
+     * @return std::string */
+    template <class T>
+    std::string print(const T& data, deref_pointers mode) {
+        std::string result;
+        const detail::instrument_call call(result);
+        {
+            detail::string_writer<std::string> out(result);
+            print(out, data, mode);
+        }
+        return result;
+    }
+
+#if __has_include(<memory_resource>)
+    /** pretty data print into memory from resource, allocated once
+     * @param data data
+     * @param resource memory resource, e.g. a std::pmr::monotonic_buffer_resource over a stack buffer
+     * @return std::pmr::string */
+    template <class T>
+    std::pmr::string print(const T& data, std::pmr::memory_resource* resource) {
+        std::pmr::string result(resource);
+        const detail::instrument_call call(result);
+        result.reserve(formatted_size(data));
+        format_to(result, data);
+        return result;
+    }
+#endif
+
+    /** pretty data print done by the compiler, for constants of integers, bool, characters, enums, strings,
+     * arrays, pairs, tuples and aggregates of them
+     * @tparam Value constant with static storage duration, e.g. static constexpr std::array<int, 3> table
+     * @return fixed_string, the same text as pretty::print(Value) */
+    template <const auto& Value>
+    constexpr const auto& static_print() noexcept {
+        return detail::static_string<Value>;
+    }
+
+    /** pretty data print into a per-thread buffer, without allocations once the buffer has grown
+     * @param data data
+     * @return std::string_view, valid until the next print_view or print_args_view call on this thread */
+    template <class T>
+    std::string_view print_view(const T& data) {
+        return format_to(detail::arena_string(), data);
+    }
+
+    /** pretty data print with type inforamation at the beginning, the readable type name taken at compile time
      * @param out Stream
      * @param data data
      * @return Stream */
-    template <class Stream, class T>
+    template <class Stream, class T, typename = std::enable_if_t<!detail::is_print_options_v<T>>>
     constexpr Stream& print_ti(Stream& out, const T& data) {
-        out << typeid(T).name() << "@";
-        print(out, data);
+        detail::instrument_call call(out);
+        detail::append(call.out(), detail::type_name<T>());
+        detail::append(call.out(), '@');
+        print(call.out(), data);
+        call.finish();
         return out;
     }
 
@@ -44,16 +272,41 @@ namespace pretty {
      * @return std::string */
     template <class T>
     std::string print_ti(const T& data) {
-        return std::string(typeid(T).name()).append("@").append(print(data));
+        const std::string_view name = detail::type_name<T>();
+        std::string result;
+        const detail::instrument_call call(result);
+        result.reserve(name.size() + 1 + formatted_size(data));
+        result.append(name).append("@");
+        format_to(result, data);
+        return result;
     }
 
+#if __has_include(<memory_resource>)
+    /** pretty data print with type inforamation at the beginning into memory from resource, allocated once
+     * @param data data
+     * @param resource memory resource
+     * @return std::pmr::string */
+    template <class T>
+    std::pmr::string print_ti(const T& data, std::pmr::memory_resource* resource) {
+        const std::string_view name = detail::type_name<T>();
+        std::pmr::string result(resource);
+        const detail::instrument_call call(result);
+        result.reserve(name.size() + 1 + formatted_size(data));
+        result.append(name).append("@");
+        format_to(result, data);
+        return result;
+    }
+#endif
+
     /** pretty data print
      * @param out Stream
      * @param args variadic data
      * @return Stream */
     template <class Stream, class... Args, typename = std::enable_if_t<(sizeof...(Args) > 1)>>
     constexpr Stream& print_args(Stream& out, Args&&... args) {
-        ((print(out, std::forward<Args>(args)) << ' '), ...);
+        detail::instrument_call call(out);
+        ((print(call.out(), std::forward<Args>(args)) << ' '), ...);
+        call.finish();
         return out;
     }
 
@@ -63,7 +316,20 @@ namespace pretty {
     template <class... Args, typename = std::enable_if_t<(sizeof...(Args) > 1)>>
     std::string print_args(Args&&... args) {
         std::string result;
-        ((result.append(print(std::forward<Args>(args))).append(" ")), ...);
+        const detail::instrument_call call(result);
+        result.reserve(((formatted_size(args) + 1) + ...));
+        ((void)format_to(result, args).append(" "), ...);
+        return result;
+    }
+
+    /** pretty data print into a per-thread buffer, without allocations once the buffer has grown
+     * @param args variadic data
+     * @return std::string_view, valid until the next print_view or print_args_view call on this thread */
+    template <class... Args, typename = std::enable_if_t<(sizeof...(Args) > 1)>>
+    std::string_view print_args_view(Args&&... args) {
+        std::string& result = detail::arena_string();
+        const detail::instrument_call call(result);
+        ((void)format_to(result, args).push_back(' '), ...);
         return result;
     }
 
@@ -73,8 +339,101 @@ namespace pretty {
      * @return Stream */
     template <class Stream, class... Args, typename = std::enable_if_t<(sizeof...(Args) > 1)>>
     void print_line(Stream& out, Args&&... args) {
-        ((print(out, std::forward<Args>(args)) << ' '), ...);
-        out << '\n';
+        detail::instrument_call call(out);
+        ((print(call.out(), std::forward<Args>(args)) << ' '), ...);
+        call.out() << '\n';
+        call.finish();
+    }
+
+    /** walk data with the type dispatch of print, emitting begin_array, begin_map, element, key, scalar and null
+     * events to backend, see text_backend, json_backend and msgpack_backend
+     * @param data data
+     * @param backend event receiver
+     * @return backend */
+    template <class T, class Backend>
+    Backend& visit(const T& data, Backend& backend) {
+        detail::traverse(backend, data);
+        return backend;
+    }
+
+    /** data as strict JSON
+     * @param data data
+     * @return std::string */
+    template <class T>
+    std::string to_json(const T& data) {
+        std::string result;
+        json_backend backend(result);
+        visit(data, backend);
+        return result;
+    }
+
+    /** data as MessagePack
+     * @param data data
+     * @return std::string of bytes */
+    template <class T>
+    std::string to_msgpack(const T& data) {
+        std::string result;
+        msgpack_backend backend(result);
+        visit(data, backend);
+        return result;
+    }
+
+    /** print the differences between two values, one line per changed, added or removed element:
+     * path: old -> new, path: + new, path: - old, where path is [index], [key] and .member steps;
+     * equal elements are compared but never formatted
+     * @param out Stream
+     * @param a first value
+     * @param b second value
+     * @return Stream */
+    template <class Stream, class T>
+    Stream& diff(Stream& out, const T& a, const T& b) {
+        detail::differ<Stream> walker(out);
+        walker.compare(a, b);
+        return out;
+    }
+
+    /** differences between two values, see diff(out, a, b)
+     * @param a first value
+     * @param b second value
+     * @return std::string, empty if nothing differs */
+    template <class T>
+    std::string diff(const T& a, const T& b) {
+        std::string result;
+        {
+            detail::string_writer<std::string> writer(result);
+            diff(writer, a, b);
+        }
+        return result;
+    }
+
+    /** read data back from the text written by pretty::print, whitespace between tokens is ignored
+     * @param text pretty::print output
+     * @return T
+     * @throw parse_error if text does not match T */
+    template <class T>
+    T parse(std::string_view text) {
+        T data{};
+        detail::parser reader(text);
+        reader.read(data);
+        reader.finish();
+        return data;
+    }
+
+    /** deferred pretty data print: nothing is formatted until the view is written to a stream or a sink,
+     * or printed with pretty::print, so it also nests in containers and print_args
+     * @param data data, kept by reference for lvalues and moved from rvalues
+     * @return lazy_view */
+    template <class T>
+    lazy_view<T> lazy(T&& data) {
+        return lazy_view<T>(std::forward<T>(data));
+    }
+
+    /** deferred pretty data print of variadic data, written like print_args
+     * @param args variadic data, kept by reference for lvalues and moved from rvalues
+     * @return lazy_args_view */
+    template <class... Args>
+    lazy_args_view<Args...> lazy_args(Args&&... args) {
+        return lazy_args_view<Args...>(std::forward<Args>(args)...);
     }
 
 }  // namespace pretty